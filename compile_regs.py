@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0
+"""Compile a GC2607 register list into the driver's init sequence
+
+Reads a .regs file (one "<reg> <value>" write per line, in the order the
+reference driver issues them) and prints a C header for gc2607.c with:
+
+  gc2607_init_segs        the writes before the stream enable
+  gc2607_init_post_segs   the writes after it
+
+Both keep the table's order. Each is a list of burst segments, a length
+byte, the 16-bit start address and that many values, ended by a zero
+length. A write joins the segment before it only when it is the next
+table entry and the next address, so merging never reorders anything.
+A write that repeats the value its register already has is dropped.
+
+Directives:
+  ordered <reg>...        always a segment of its own and never dropped as a
+                          repeat; a write to one also ends the run of writes
+                          that later repeats are checked against
+  stream <reg> <value>    the stream enable write; dropped, the driver issues
+                          it after the control replay and writes
+                          gc2607_init_post_segs after it
+  control <reg>...        owned by a V4L2 control; the replay at every full
+                          init overwrites the table value, so it is dropped
+
+Usage: compile_regs.py gc2607_init.regs > gc2607_init_regs.h
+"""
+
+import os
+import sys
+
+REG_MAX = 0x0fff        # GC2607_REG_MAX
+SEG_MAX = 0xff          # Segment length is a single byte
+
+
+def parse_int(tok, path, lineno, limit):
+    try:
+        val = int(tok, 0)
+    except ValueError:
+        sys.exit(f"{path}:{lineno}: bad number '{tok}'")
+    if not 0 <= val <= limit:
+        sys.exit(f"{path}:{lineno}: 0x{val:x} out of range")
+    return val
+
+
+def parse(path):
+    """Return (writes, ordered, stream, control) from a .regs file"""
+    writes = []
+    ordered = set()
+    control = set()
+    stream = None
+
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            toks = line.split('#', 1)[0].split()
+            if not toks:
+                continue
+
+            if toks[0] in ('ordered', 'control'):
+                regs = {parse_int(t, path, lineno, REG_MAX) for t in toks[1:]}
+                (ordered if toks[0] == 'ordered' else control).update(regs)
+            elif toks[0] == 'stream' and len(toks) == 3:
+                stream = (parse_int(toks[1], path, lineno, REG_MAX),
+                          parse_int(toks[2], path, lineno, 0xff))
+            elif len(toks) == 2:
+                reg = parse_int(toks[0], path, lineno, REG_MAX)
+                if reg == 0:
+                    sys.exit(f"{path}:{lineno}: 0x0000 is GC2607_REG_DELAY")
+                writes.append((reg, parse_int(toks[1], path, lineno, 0xff)))
+            else:
+                sys.exit(f"{path}:{lineno}: cannot parse '{line.strip()}'")
+
+    if ordered & control:
+        sys.exit(f"{path}: registers both ordered and control")
+    return writes, ordered, stream, control
+
+
+def compile_regs(writes, ordered, stream, control):
+    """Split the writes at the stream enable into two segment lists"""
+    pre, post = [], []
+    segs = pre
+    last = {}
+    stats = {'ordered': 0, 'control': 0, 'repeated': 0}
+
+    for reg, val in writes:
+        if (reg, val) == stream:
+            if segs is post:
+                sys.exit("stream enable written twice")
+            segs = post
+        elif reg in ordered:
+            if segs is post:
+                sys.exit(f"ordered write 0x{reg:04x} after the stream enable")
+            # A segment of its own, and nothing before it counts as a repeat
+            segs.append((reg, [val], True))
+            last = {}
+            stats['ordered'] += 1
+        elif reg in control:
+            if segs is post:
+                sys.exit(f"control write 0x{reg:04x} after the stream enable")
+            stats['control'] += 1
+        elif last.get(reg) == val:
+            stats['repeated'] += 1
+        else:
+            last[reg] = val
+            # Extend the previous burst if this is its next address
+            if segs and not segs[-1][2] and \
+               reg == segs[-1][0] + len(segs[-1][1]) and \
+               len(segs[-1][1]) < SEG_MAX:
+                segs[-1][1].append(val)
+            else:
+                segs.append((reg, [val], False))
+
+    if stream and segs is not post:
+        sys.exit("stream enable not found in the table")
+
+    return pre, post, stats
+
+
+def emit_segs(name, segs):
+    print(f"static const u8 {name}[] = {{")
+    for reg, vals, _ in segs:
+        for i in range(0, len(vals), 8):
+            data = ", ".join(f"0x{v:02x}" for v in vals[i:i + 8])
+            if i == 0:
+                print(f"\t{len(vals)}, 0x{reg >> 8:02x}, 0x{reg & 0xff:02x}, "
+                      f"{data},")
+            else:
+                print(f"\t\t{data},")
+    print("\t0")
+    print("};")
+
+
+def emit(src, writes, pre, post, stats):
+    nregs = sum(len(vals) for _, vals, _ in pre + post)
+    nbytes = sum(3 + len(vals) for _, vals, _ in pre + post) + 2
+
+    print("/* SPDX-License-Identifier: GPL-2.0 */")
+    print(f"/* Generated by compile_regs.py from {src}, do not edit */")
+    print()
+    print("/*")
+    print(f" * {len(writes)} table writes: {stats['control']} owned by controls, "
+          f"{stats['repeated']} repeating the")
+    print(f" * value already written, 1 stream enable. {nregs} writes remain, "
+          f"{stats['ordered']} of them")
+    print(f" * ordered, in {len(pre)} + {len(post)} segments of "
+          f"{nbytes} bytes.")
+    print(" */")
+    print()
+    print("/* Length, start address high and low byte, values; 0 ends */")
+    emit_segs("gc2607_init_segs", pre)
+    print()
+    emit_segs("gc2607_init_post_segs", post)
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip().splitlines()[-1], file=sys.stderr)
+        sys.exit(1)
+
+    writes, ordered, stream, control = parse(sys.argv[1])
+    pre, post, stats = compile_regs(writes, ordered, stream, control)
+    emit(os.path.basename(sys.argv[1]), writes, pre, post, stats)
+
+
+if __name__ == "__main__":
+    main()
@@ -26,40 +26,32 @@ fi
 echo "Virtual camera device: $VIRT_DEV"
 echo ""
 
-# Set optimal exposure/gain for good brightness
-# Exposure: 2002 (max), Gain: 16 (max, LUT index)
+# Starting exposure/gain; gc2607-loopback --ae adjusts them per frame
+# Exposure: 2002 (max), Gain: 1012 (max, 15.8x in 1/64 units)
 echo "Setting camera parameters..."
-v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=16
+v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=1012
 
 # White balance gains (calculated from gray world)
 R_GAIN=1.034
 G_GAIN=1.000
 B_GAIN=1.246
 
-# Convert to frei0r parameters (0.5 = neutral)
-R_PARAM=$(echo "scale=3; 0.5 * $R_GAIN" | bc)
-G_PARAM=$(echo "scale=3; 0.5 * $G_GAIN" | bc)
-B_PARAM=$(echo "scale=3; 0.5 * $B_GAIN" | bc)
+# Native converter/loopback daemon (built on first use)
+LOOPBACK="$(dirname "$0")/tools/gc2607-loopback"
+if [ ! -x "$LOOPBACK" ]; then
+    echo "Building $LOOPBACK..."
+    make -C "$(dirname "$0")/tools" gc2607-loopback
+fi
 
 echo ""
-echo "Starting Bayer to RGB conversion pipeline with white balance..."
+echo "Starting Bayer to YUV conversion with white balance..."
 echo "WB gains: R=$R_GAIN, G=$G_GAIN, B=$B_GAIN"
 echo "Press Ctrl+C to stop"
 echo ""
 
-# Use gstreamer to convert Bayer to RGB and feed to virtual camera
-# videoflip method=rotate-180 flips the image right-side up
-gst-launch-1.0 -v \
-    v4l2src device=/dev/video0 ! \
-    "video/x-bayer,format=grbg10le,width=1920,height=1080,framerate=30/1" ! \
-    bayer2rgb ! \
-    videoflip method=rotate-180 ! \
-    videoconvert ! \
-    "video/x-raw,format=RGBA" ! \
-    frei0r-filter-coloradj-rgb r=$R_PARAM g=$G_PARAM b=$B_PARAM keep-luma=false ! \
-    videoconvert ! \
-    "video/x-raw,format=YUY2" ! \
-    v4l2sink device=$VIRT_DEV
+# Demosaic, white balance, rotate by 180 degrees (the sensor is mounted
+# upside down) and convert to YUY2 in one pass into the loopback buffers
+"$LOOPBACK" -f yuy2 -w "$R_GAIN,$G_GAIN,$B_GAIN" --ae /dev/v4l-subdev6 /dev/video0 "$VIRT_DEV"
 
 echo ""
 echo "Pipeline stopped."
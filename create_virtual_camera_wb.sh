@@ -35,13 +35,13 @@ fi
 echo "Virtual camera device: $VIRT_DEV"
 echo ""
 
-# Set optimal exposure/gain for good brightness
-# Exposure: 2002 (max), Gain: 16 (max, LUT index)
+# Starting exposure/gain; gc2607-loopback --ae adjusts them per frame
+# Exposure: 2002 (max), Gain: 1012 (max, 15.8x in 1/64 units)
 echo "Setting camera parameters..."
-v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=16
+v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=1012
 
 echo ""
-echo "Starting Bayer to RGB conversion pipeline with WHITE BALANCE..."
+echo "Starting Bayer to YUV conversion with WHITE BALANCE..."
 echo "Press Ctrl+C to stop"
 echo ""
 echo "Adjust white balance by restarting with different gains:"
@@ -49,27 +49,15 @@ echo "  $0 1.0 1.0 1.3  # Reduce red, increase blue"
 echo "  $0 1.5 1.0 1.2  # Increase red, increase blue"
 echo ""
 
-# GStreamer pipeline with white balance using frei0r coloradj_RGB
-# frei0r r/g/b parameters: 0.0-1.0, where 0.5 is neutral (1.0x gain)
-# Convert our gains to frei0r parameters: param = 0.5 * gain
-R_PARAM=$(echo "scale=3; 0.5 * $R_GAIN" | bc)
-G_PARAM=$(echo "scale=3; 0.5 * $G_GAIN" | bc)
-B_PARAM=$(echo "scale=3; 0.5 * $B_GAIN" | bc)
-
-echo "Frei0r RGB parameters: r=$R_PARAM, g=$G_PARAM, b=$B_PARAM"
-echo ""
+# Native converter/loopback daemon (built on first use)
+LOOPBACK="$(dirname "$0")/tools/gc2607-loopback"
+if [ ! -x "$LOOPBACK" ]; then
+    echo "Building $LOOPBACK..."
+    make -C "$(dirname "$0")/tools" gc2607-loopback
+fi
 
-gst-launch-1.0 -v \
-    v4l2src device=/dev/video0 ! \
-    "video/x-bayer,format=grbg10le,width=1920,height=1080,framerate=30/1" ! \
-    bayer2rgb ! \
-    videoflip method=rotate-180 ! \
-    videoconvert ! \
-    "video/x-raw,format=RGBA" ! \
-    frei0r-filter-coloradj-rgb r=$R_PARAM g=$G_PARAM b=$B_PARAM keep-luma=false ! \
-    videoconvert ! \
-    "video/x-raw,format=YUY2" ! \
-    v4l2sink device=$VIRT_DEV
+# The gains are applied to the raw Bayer channels before demosaicing
+"$LOOPBACK" -f yuy2 -w "$R_GAIN,$G_GAIN,$B_GAIN" --ae /dev/v4l-subdev6 /dev/video0 "$VIRT_DEV"
 
 echo ""
 echo "Pipeline stopped."
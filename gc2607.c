@@ -9,22 +9,76 @@
 
 #include <linux/acpi.h>
 #include <linux/clk.h>
+#include <linux/debugfs.h>
 #include <linux/delay.h>
+#include <linux/gcd.h>
 #include <linux/gpio/consumer.h>
 #include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <linux/module.h>
 #include <linux/pm_runtime.h>
+#include <linux/property.h>
+#include <linux/regmap.h>
 #include <linux/regulator/consumer.h>
+#include <linux/slab.h>
+#include <linux/unaligned.h>
 #include <media/v4l2-ctrls.h>
 #include <media/v4l2-device.h>
 #include <media/v4l2-fwnode.h>
+#include <media/v4l2-rect.h>
 #include <media/v4l2-async.h>
 
+/*
+ * The KUnit suite is built in through tests/Kconfig in a kernel tree, or
+ * with "make KUNIT=1", which defines GC2607_KUNIT. It stubs out power
+ * sequencing; without it the hooks compile to nothing and the kunit
+ * headers are not pulled in.
+ */
+#if IS_ENABLED(CONFIG_VIDEO_GC2607_KUNIT_TEST) && !defined(GC2607_KUNIT)
+#define GC2607_KUNIT
+#endif
+
+#ifdef GC2607_KUNIT
+#include <kunit/static_stub.h>
+#define gc2607_stub_redirect(fn, args...) KUNIT_STATIC_STUB_REDIRECT(fn, args)
+#else
+#define gc2607_stub_redirect(fn, args...) do { } while (0)
+#endif
+
+#define CREATE_TRACE_POINTS
+#include "gc2607_trace.h"
+
 #define GC2607_CHIP_ID_H		0x26
 #define GC2607_CHIP_ID_L		0x07
 #define GC2607_REG_CHIP_ID_H		0x03f0
 #define GC2607_REG_CHIP_ID_L		0x03f1
 
+/* Registers written only through ordered sequences, never via the cache */
+#define GC2607_REG_SOFT_RESET		0x03fe
+#define GC2607_REG_MIPI_CTRL		0x0117
+#define GC2607_MIPI_STREAM_ON		0x91
+#define GC2607_MIPI_STREAM_OFF		0x01
+
+/* Highest register address the regmap will accept */
+#define GC2607_REG_MAX			0x0fff
+
+/* Burst writes: the sensor auto-increments the address after each byte */
+#define GC2607_BURST_MAX		16	/* Data bytes per burst message */
+#define GC2607_BATCH_MSGS		8	/* Messages per i2c_transfer() */
+#define GC2607_BATCH_BUF_SIZE		128	/* Address + data bytes per batch */
+
+/*
+ * Settle time after the soft reset writes. The reference driver has none but
+ * sends every write as a transaction of its own; this is a margin, not a
+ * datasheet value.
+ */
+#define GC2607_SOFT_RESET_US		1000
+
+/* Failed transfers are retried with a doubling backoff: 100, 200, 400 us */
+#define GC2607_I2C_RETRIES		3
+#define GC2607_I2C_BACKOFF_US		100
+
 /* Special register markers for initialization arrays */
 #define GC2607_REG_END			0xffff
 #define GC2607_REG_DELAY		0x0000
@@ -43,28 +97,108 @@
 #define GC2607_EXPOSURE_STEP		1
 #define GC2607_EXPOSURE_DEFAULT		2002	/* Tested optimal for indoor use */
 
-/* Gain is controlled via LUT index (0-16), not raw register values */
-#define GC2607_GAIN_MIN			0	/* LUT index 0 = 1.0x gain */
-#define GC2607_GAIN_MAX			16	/* LUT index 16 = 15.8x gain */
-#define GC2607_GAIN_STEP		1	/* One LUT entry at a time */
-#define GC2607_GAIN_DEFAULT		14	/* LUT index 14 = ~10x gain */
+/*
+ * Gain is a linear code, gain x 64. The reference driver's LUT gain column
+ * is log2(gain) in Q16 instead (16247 for 1.1875x); its entries are
+ * converted, not copied.
+ */
+#define GC2607_GAIN_MIN			64	/* 1.0x, LUT entry 0 */
+#define GC2607_GAIN_MAX			1012	/* 15.8x, LUT entry 16 */
+#define GC2607_GAIN_STEP		1
+#define GC2607_GAIN_DEFAULT		717	/* 11.2x, LUT entry 14 */
+
+/*
+ * Digital gain on top of the LUT, also in 1/64 units. It multiplies the
+ * 0x020c/0x020d value the analogue gain selects, whose top byte holds four
+ * bits, so 4x at the top LUT entry is as far as the register reaches.
+ */
+#define GC2607_DGAIN_MIN		64	/* 1.0x */
+#define GC2607_DGAIN_MAX		256	/* 4.0x */
+#define GC2607_DGAIN_STEP		1
+#define GC2607_DGAIN_DEFAULT		64
+#define GC2607_DGAIN_REG_MAX		0x0fff
 
-/* Sensor timing - modified for better low-light performance */
-#define GC2607_PIXEL_RATE		(672000000LL / 10 * 2)  /* 134.4 MHz */
+/*
+ * Sensor timing - modified for better low-light performance
+ *
+ * The pixel array is clocked at the rate the reference gc2607_set_fps()
+ * uses (sclk = VTS 1335 x HTS 2048 x 30 fps), so that frame rate =
+ * pixel rate / (HTS x VTS) holds for the reported blanking. The MIPI link
+ * itself runs faster, at 672 Mbps on each of 2 lanes.
+ */
+#define GC2607_PIXEL_RATE		(1335LL * 2048 * 30)  /* 82.0224 MHz */
 #define GC2607_LINK_FREQ		336000000LL  /* 672 Mbps / 2 lanes */
 #define GC2607_HTS			2048
 #define GC2607_VTS			2003  /* 1.5x from 1335 for 1.5x exposure (20 FPS) */
+#define GC2607_VTS_MAX			8010  /* 5 fps, the reference minimum */
+
+/*
+ * Readout direction, owned by V4L2_CID_HFLIP/VFLIP. Reversing the readout
+ * within the window changes the colour of the first pixel of each row
+ * (mirror) and of the first row (flip), and with it the Bayer order.
+ */
+#define GC2607_REG_FLIP			0x0101
+#define GC2607_FLIP_H			BIT(0)
+#define GC2607_FLIP_V			BIT(1)
+
+/* Frame length (VTS) registers, owned by V4L2_CID_VBLANK */
+#define GC2607_REG_VTS_H		0x0220
+#define GC2607_REG_VTS_L		0x0221
 #define GC2607_WIDTH			1920
 #define GC2607_HEIGHT			1080
 
+/*
+ * Readout window registers. The init table reads out GC2607_HEIGHT rows
+ * plus 4 margin rows above and below from row 2, and GC2607_WIDTH columns
+ * from column 4; that 1920x1080 area is the crop bounds. The MIPI line
+ * length is the window width in RAW10 bytes, the second value half of it
+ * plus one, as in the init table.
+ */
+#define GC2607_REG_ROW_START_H		0x0346
+#define GC2607_REG_ROW_START_L		0x0347
+#define GC2607_REG_ROW_COUNT_H		0x034a
+#define GC2607_REG_ROW_COUNT_L		0x034b
+#define GC2607_REG_COL_COUNT_H		0x034c
+#define GC2607_REG_COL_COUNT_L		0x034d
+#define GC2607_REG_COL_START_H		0x0353
+#define GC2607_REG_COL_START_L		0x0354
+#define GC2607_REG_MIPI_LINE_H		0x0d84
+#define GC2607_REG_MIPI_LINE_L		0x0d85
+#define GC2607_REG_MIPI_HALF_H		0x0d86
+#define GC2607_REG_MIPI_HALF_L		0x0d87
+#define GC2607_ROW_START		2
+#define GC2607_ROW_MARGIN		8
+#define GC2607_COL_START		4
+
+/* Crop limits; even offsets keep the Bayer order, RAW10 packs 4 pixels */
+#define GC2607_CROP_MIN_WIDTH		64
+#define GC2607_CROP_MIN_HEIGHT		64
+#define GC2607_CROP_WIDTH_ALIGN		4
+#define GC2607_CROP_HEIGHT_ALIGN	2
+
+/* Default runtime PM autosuspend delay (ms), see power/autosuspend_delay_ms */
+static int autosuspend_delay_ms = 2000;
+module_param(autosuspend_delay_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_delay_ms,
+		 "Initial runtime PM autosuspend delay in ms (default 2000)");
+
 /* Register value pair for initialization sequences */
 struct gc2607_regval {
 	u16 addr;
 	u8 val;
 };
 
+/*
+ * Register initialization sequence for 1920x1080@30fps MIPI mode, compiled
+ * from gc2607_init.regs by compile_regs.py at build time into burst
+ * segments in table order: gc2607_init_segs up to the stream enable,
+ * gc2607_init_post_segs after it.
+ */
+#include "gc2607_init_regs.h"
+
 /* Gain lookup table entry - from reference driver */
 struct gc2607_gain_lut {
+	u16 gain;	/* Linear, 1/64 units */
 	u8 reg2b3;
 	u8 reg2b4;
 	u8 reg20c;
@@ -73,65 +207,174 @@ struct gc2607_gain_lut {
 
 /* Gain lookup table for optimal noise performance
  * Using 4 registers together provides better image quality than single register
- * Table from reference driver - maps gain levels to register combinations
+ * Table from reference driver - maps gain levels to register combinations.
+ * 0x020c/0x020d is a linear gain with 0x0040 = 1.0x; between entries it
+ * is scaled to make up the rest of the requested gain.
  */
 static const struct gc2607_gain_lut gc2607_gain_table[] = {
-	{0x00, 0x00, 0x00, 0x40},  /* Gain index 0  - lowest gain */
-	{0x05, 0x00, 0x00, 0x4b},  /* Gain index 1 */
-	{0x00, 0x01, 0x00, 0x59},  /* Gain index 2 */
-	{0x05, 0x01, 0x00, 0x6a},  /* Gain index 3 */
-	{0x00, 0x02, 0x00, 0x80},  /* Gain index 4 */
-	{0x05, 0x02, 0x00, 0x97},  /* Gain index 5 */
-	{0x00, 0x03, 0x00, 0xb3},  /* Gain index 6 */
-	{0x05, 0x03, 0x00, 0xd4},  /* Gain index 7 */
-	{0x00, 0x04, 0x01, 0x00},  /* Gain index 8 */
-	{0x05, 0x04, 0x01, 0x2f},  /* Gain index 9 */
-	{0x00, 0x05, 0x01, 0x66},  /* Gain index 10 */
-	{0x05, 0x05, 0x01, 0xa8},  /* Gain index 11 */
-	{0x00, 0x06, 0x02, 0x00},  /* Gain index 12 */
-	{0x05, 0x06, 0x02, 0x5e},  /* Gain index 13 */
-	{0x09, 0x26, 0x02, 0xcc},  /* Gain index 14 */
-	{0x0c, 0xb6, 0x03, 0x50},  /* Gain index 15 */
-	{0x10, 0x06, 0x04, 0x00},  /* Gain index 16 - highest gain */
+	{  64, 0x00, 0x00, 0x00, 0x40},  /* 1.000000x - lowest gain */
+	{  76, 0x05, 0x00, 0x00, 0x4b},  /* 1.187500x */
+	{  93, 0x00, 0x01, 0x00, 0x59},  /* 1.453125x */
+	{ 111, 0x05, 0x01, 0x00, 0x6a},  /* 1.734375x */
+	{ 130, 0x00, 0x02, 0x00, 0x80},  /* 2.031250x */
+	{ 156, 0x05, 0x02, 0x00, 0x97},  /* 2.437500x */
+	{ 184, 0x00, 0x03, 0x00, 0xb3},  /* 2.875000x */
+	{ 221, 0x05, 0x03, 0x00, 0xd4},  /* 3.453125x */
+	{ 253, 0x00, 0x04, 0x01, 0x00},  /* 3.953125x */
+	{ 304, 0x05, 0x04, 0x01, 0x2f},  /* 4.750000x */
+	{ 367, 0x00, 0x05, 0x01, 0x66},  /* 5.734375x */
+	{ 434, 0x05, 0x05, 0x01, 0xa8},  /* 6.781250x */
+	{ 510, 0x00, 0x06, 0x02, 0x00},  /* 7.968750x */
+	{ 607, 0x05, 0x06, 0x02, 0x5e},  /* 9.484375x */
+	{ 717, 0x09, 0x26, 0x02, 0xcc},  /* 11.203125x */
+	{ 847, 0x0c, 0xb6, 0x03, 0x50},  /* 13.234375x */
+	{1012, 0x10, 0x06, 0x04, 0x00},  /* 15.812500x - highest gain */
 };
 
 #define GC2607_GAIN_TABLE_SIZE ARRAY_SIZE(gc2607_gain_table)
 
-/* Sensor mode structure */
+/*
+ * Sensor mode structure. A mode is a crop of the pixel array plus the
+ * frame timing that crop allows; every mode shares gc2607_init_segs.
+ */
 struct gc2607_mode {
 	u32 width;
 	u32 height;
 	u32 hts;
 	u32 vts;
 	u32 max_fps;
-	const struct gc2607_regval *reg_list;
+	u32 link_freq_index;	/* Index into gc2607_link_freqs[] */
+	s64 pixel_rate;
+	struct v4l2_rect crop;	/* Relative to the crop bounds */
+};
+
+/*
+ * Shortest frame length that still allows the mode's maximum frame rate;
+ * max_fps must only hold rates measured on the sensor.
+ */
+static inline u32 gc2607_vts_min(const struct gc2607_mode *mode)
+{
+	return DIV_ROUND_UP_ULL(mode->pixel_rate, (u64)mode->hts * mode->max_fps);
+}
+
+/*
+ * Power-on sequence timings, in microseconds. Each is the wait after the
+ * corresponding step:
+ * @supply_us:        regulators enabled until supplies are stable
+ * @clk_to_reset_us:  master clock enabled until the reset sequence
+ * @pre_reset_us:     reset released before the reset pulse
+ * @reset_us:         reset asserted
+ * @post_reset_us:    reset released until the power-down pulse
+ * @powerdown_us:     each half of the power-down pulse
+ * @boot_us:          sequence done until the first I2C access
+ */
+struct gc2607_power_timing {
+	u32 supply_us;
+	u32 clk_to_reset_us;
+	u32 pre_reset_us;
+	u32 reset_us;
+	u32 post_reset_us;
+	u32 powerdown_us;
+	u32 boot_us;
+};
+
+/*
+ * The ~100 ms sequence validated on hardware: the reference driver's reset
+ * and power-down phases (gc2607.c:689-707) with 5 ms supply and clock
+ * settling. There are no datasheet minimums to go by, so platforms that
+ * have validated shorter waits set them through firmware properties.
+ */
+static const struct gc2607_power_timing gc2607_default_timing = {
+	.supply_us = 5000,
+	.clk_to_reset_us = 5000,
+	.pre_reset_us = 20000,
+	.reset_us = 20000,
+	.post_reset_us = 10000,
+	.powerdown_us = 10000,
+	.boot_us = 20000,
+};
+
+/*
+ * Statistics in debugfs, cheap enough to stay on: atomic counters only,
+ * no locks. Every field is an atomic64_t so the whole block can be reset
+ * in a loop.
+ */
+#define GC2607_STATS_HIST_BUCKETS	16	/* log2(us), last bucket open */
+
+/* Controls with their own latency counters; clusters by their first */
+static const u32 gc2607_stats_ctrls[] = {
+	V4L2_CID_EXPOSURE,
+	V4L2_CID_VBLANK,
+	V4L2_CID_HFLIP,
+};
+
+struct gc2607_stat {
+	atomic64_t count;
+	atomic64_t errors;
+	atomic64_t total_us;
+	atomic64_t max_us;
+};
+
+struct gc2607_stats {
+	atomic64_t i2c_xfers;
+	atomic64_t i2c_bytes;
+	atomic64_t i2c_retries;
+	atomic64_t i2c_errors;
+	atomic64_t recoveries;		/* Power cycles after failed retries */
+	atomic64_t recovery_failures;
+	/* Bucket b counts transfers of [2^(b-1), 2^b) us, bucket 0 under 1 us */
+	atomic64_t i2c_hist[GC2607_STATS_HIST_BUCKETS];
+
+	struct gc2607_stat power_on;
+	struct gc2607_stat power_off;
+	struct gc2607_stat stream_init;		/* STREAMON with full init */
+	struct gc2607_stat stream_restart;	/* STREAMON, registers kept */
+	struct gc2607_stat ctrl[ARRAY_SIZE(gc2607_stats_ctrls)];
 };
 
 struct gc2607 {
 	struct v4l2_subdev sd;
 	struct media_pad pad;
 	struct i2c_client *client;
+	struct regmap *regmap;
 
 	/* V4L2 controls */
 	struct v4l2_ctrl_handler ctrls;
 	struct v4l2_ctrl *link_freq;
 	struct v4l2_ctrl *pixel_rate;
-	struct v4l2_ctrl *exposure;
-	struct v4l2_ctrl *gain;
+	struct v4l2_ctrl *vblank;
+	struct v4l2_ctrl *hblank;
+	struct {
+		/* Exposure/gain cluster, written as one transfer */
+		struct v4l2_ctrl *exposure;
+		struct v4l2_ctrl *gain;
+		struct v4l2_ctrl *digital_gain;
+	};
+	struct {
+		/* Readout direction cluster, one register */
+		struct v4l2_ctrl *hflip;
+		struct v4l2_ctrl *vflip;
+	};
 
 	/* Power management resources (provided by INT3472 PMIC) */
 	struct clk *xclk;		/* Master clock (typically 19.2 MHz) */
 	struct gpio_desc *reset_gpio;	/* Reset GPIO (active low) */
 	struct gpio_desc *powerdown_gpio; /* Power-down GPIO (if present) */
 	struct regulator_bulk_data supplies[3];
-
-	/* Current mode and format */
-	const struct gc2607_mode *cur_mode;
-	struct v4l2_mbus_framefmt fmt;
+	struct gc2607_power_timing timing;
+	u64 power_on_us;		/* Measured duration of the last power-on */
 
 	/* Device state */
 	bool streaming;
 	bool powered;
+	bool regs_valid;	/* Sensor programmed since last power-on */
+
+	/* I2C transactions and bytes since probe (per STREAMON, in traces) */
+	u32 xfer_count;
+	u32 xfer_bytes;
+
+	struct gc2607_stats stats;
+	atomic_t fail_xfers;	/* debugfs fault injection: attempts to fail */
 };
 
 static inline struct gc2607 *to_gc2607(struct v4l2_subdev *sd)
@@ -139,219 +382,394 @@ static inline struct gc2607 *to_gc2607(struct v4l2_subdev *sd)
 	return container_of(sd, struct gc2607, sd);
 }
 
+static void gc2607_stat_add(struct gc2607_stat *st, s64 us, int ret)
+{
+	s64 max = atomic64_read(&st->max_us);
+
+	atomic64_inc(&st->count);
+	if (ret)
+		atomic64_inc(&st->errors);
+	atomic64_add(us, &st->total_us);
+	while (us > max && !atomic64_try_cmpxchg(&st->max_us, &max, us))
+		;
+}
+
+/* Account one I2C transfer attempt of @bytes started at @start */
+static void gc2607_i2c_done(struct gc2607 *gc2607, ktime_t start,
+			    unsigned int bytes, int ret)
+{
+	struct gc2607_stats *st = &gc2607->stats;
+	s64 us = ktime_us_delta(ktime_get(), start);
+
+	gc2607->xfer_count++;
+	gc2607->xfer_bytes += bytes;
+
+	atomic64_inc(&st->i2c_xfers);
+	atomic64_add(bytes, &st->i2c_bytes);
+	if (ret < 0)
+		atomic64_inc(&st->i2c_errors);
+	atomic64_inc(&st->i2c_hist[min(fls64(us),
+				       GC2607_STATS_HIST_BUCKETS - 1)]);
+}
+
 /*
  * I2C I/O operations
  * GC2607 uses 16-bit register addresses and 8-bit values
+ *
+ * Register access goes through a regmap with an rbtree cache. The regmap
+ * bus below is the only place that talks to the I2C adapter for single and
+ * burst accesses; the sensor auto-increments the address within a burst.
+ *
+ * The cache holds the registers the driver sets at runtime rather than the
+ * init table: the readout window of the current crop and the flip register.
+ * Both survive a power-off there. A full init writes the compiled table in
+ * its own order and takes the window from the cache at its place in the
+ * table; the control replay then writes the flips.
  */
-static int gc2607_read_reg(struct gc2607 *gc2607, u16 reg, u8 *val)
+/*
+ * i2c_transfer() with bounded retries, so a single NAK or bus glitch does
+ * not abort a whole table. -EOPNOTSUPP is returned at once for the
+ * caller's fallback. The fail_xfers debugfs knob fails the next attempts
+ * with -EREMOTEIO, to exercise this and the recovery on any adapter.
+ */
+static int gc2607_i2c_transfer(struct gc2607 *gc2607, struct i2c_msg *msgs,
+			       int num)
 {
 	struct i2c_client *client = gc2607->client;
-	struct i2c_msg msgs[2];
-	u8 addr_buf[2];
-	int ret;
+	unsigned int bytes = 0, attempt;
+	ktime_t start;
+	int i, ret;
+
+	for (i = 0; i < num; i++)
+		bytes += msgs[i].len;
+
+	for (attempt = 0; ; attempt++) {
+		start = ktime_get();
+		if (atomic_dec_if_positive(&gc2607->fail_xfers) >= 0)
+			ret = -EREMOTEIO;
+		else
+			ret = i2c_transfer(client->adapter, msgs, num);
+		if (ret == -EOPNOTSUPP)
+			return ret;
+
+		gc2607_i2c_done(gc2607, start, bytes, ret);
+		if (ret >= 0 || attempt == GC2607_I2C_RETRIES)
+			break;
 
-	addr_buf[0] = reg >> 8;
-	addr_buf[1] = reg & 0xff;
+		atomic64_inc(&gc2607->stats.i2c_retries);
+		fsleep(GC2607_I2C_BACKOFF_US << attempt);
+	}
+
+	if (ret < 0)
+		return ret;
+
+	return ret == num ? 0 : -EIO;
+}
+
+static int gc2607_i2c_write(void *context, const void *data, size_t count)
+{
+	struct gc2607 *gc2607 = context;
+	struct i2c_msg msg = {
+		.addr = gc2607->client->addr,
+		.len = count,
+		.buf = (u8 *)data,
+	};
+
+	return gc2607_i2c_transfer(gc2607, &msg, 1);
+}
+
+static int gc2607_i2c_read(void *context, const void *reg_buf, size_t reg_size,
+			   void *val_buf, size_t val_size)
+{
+	struct gc2607 *gc2607 = context;
+	struct i2c_client *client = gc2607->client;
+	struct i2c_msg msgs[2];
 
 	/* Write register address */
 	msgs[0].addr = client->addr;
 	msgs[0].flags = 0;
-	msgs[0].len = 2;
-	msgs[0].buf = addr_buf;
+	msgs[0].len = reg_size;
+	msgs[0].buf = (u8 *)reg_buf;
 
 	/* Read data */
 	msgs[1].addr = client->addr;
 	msgs[1].flags = I2C_M_RD;
-	msgs[1].len = 1;
-	msgs[1].buf = val;
+	msgs[1].len = val_size;
+	msgs[1].buf = val_buf;
+
+	return gc2607_i2c_transfer(gc2607, msgs, 2);
+}
+
+static const struct regmap_bus gc2607_regmap_bus = {
+	.write = gc2607_i2c_write,
+	.read = gc2607_i2c_read,
+	.reg_format_endian_default = REGMAP_ENDIAN_BIG,
+	.val_format_endian_default = REGMAP_ENDIAN_BIG,
+	.max_raw_write = GC2607_BURST_MAX,
+};
 
-	ret = i2c_transfer(client->adapter, msgs, 2);
-	if (ret < 0) {
-		dev_err(&client->dev, "Failed to read reg 0x%04x: %d\n", reg, ret);
+/*
+ * Registers that must never be served from the cache: the chip ID, the
+ * soft reset and the MIPI stream control, which are ordering sensitive and
+ * only written through explicit sequences, and the exposure, gain and frame
+ * length registers, which belong to the controls and are rewritten by them
+ * after every full init.
+ */
+static bool gc2607_volatile_reg(struct device *dev, unsigned int reg)
+{
+	switch (reg) {
+	case GC2607_REG_CHIP_ID_H:
+	case GC2607_REG_CHIP_ID_L:
+	case GC2607_REG_SOFT_RESET:
+	case GC2607_REG_MIPI_CTRL:
+	case GC2607_REG_EXPOSURE_H:
+	case GC2607_REG_EXPOSURE_L:
+	case GC2607_REG_AGAIN_H:
+	case GC2607_REG_AGAIN_L:
+	case GC2607_REG_DGAIN_H:
+	case GC2607_REG_DGAIN_L:
+	case GC2607_REG_VTS_H:
+	case GC2607_REG_VTS_L:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static const struct regmap_config gc2607_regmap_config = {
+	.reg_bits = 16,
+	.val_bits = 8,
+	.max_register = GC2607_REG_MAX,
+	.volatile_reg = gc2607_volatile_reg,
+	.cache_type = REGCACHE_RBTREE,
+};
+
+static int gc2607_read_reg(struct gc2607 *gc2607, u16 reg, u8 *val)
+{
+	unsigned int v;
+	int ret;
+
+	ret = regmap_read(gc2607->regmap, reg, &v);
+	if (ret) {
+		dev_err(&gc2607->client->dev, "Failed to read reg 0x%04x: %d\n",
+			reg, ret);
 		return ret;
 	}
 
+	*val = v;
 	return 0;
 }
 
 static int gc2607_write_reg(struct gc2607 *gc2607, u16 reg, u8 val)
+{
+	int ret;
+
+	ret = regmap_write(gc2607->regmap, reg, val);
+	if (ret)
+		dev_err(&gc2607->client->dev, "Failed to write reg 0x%04x: %d\n",
+			reg, ret);
+
+	return ret;
+}
+
+/*
+ * Batched table programming
+ *
+ * Runs of consecutive register addresses are merged into one auto-increment
+ * burst (16-bit start address followed by N data bytes), and independent
+ * bursts are packed into a single i2c_transfer() message array.
+ *
+ * This path bypasses the regmap. It writes the ordered sequences (soft
+ * reset, stream on/off), whose registers are volatile, and the compiled init
+ * segments with their values taken from the register cache.
+ *
+ * Soft reset writes are never batched: each goes out in a transfer of its
+ * own, as in the reference driver, and the next write waits
+ * GC2607_SOFT_RESET_US for the digital core to come back.
+ */
+struct gc2607_batch {
+	struct i2c_msg msgs[GC2607_BATCH_MSGS];
+	u8 buf[GC2607_BATCH_BUF_SIZE];
+	unsigned int nmsgs;
+	unsigned int used;
+	u16 next_addr;		/* Address that would extend the open burst */
+	bool reset;		/* Soft reset queued or sent, settle time owed */
+};
+
+static int gc2607_batch_flush(struct gc2607 *gc2607, struct gc2607_batch *b)
 {
 	struct i2c_client *client = gc2607->client;
-	u8 buf[3];
+	unsigned int i;
 	int ret;
 
-	buf[0] = reg >> 8;
-	buf[1] = reg & 0xff;
-	buf[2] = val;
+	if (!b->nmsgs)
+		return 0;
+
+	ret = gc2607_i2c_transfer(gc2607, b->msgs, b->nmsgs);
+
+	/* Some adapters limit messages per transfer; send them one by one */
+	if (ret == -EOPNOTSUPP) {
+		for (i = 0; i < b->nmsgs; i++) {
+			ret = gc2607_i2c_transfer(gc2607, &b->msgs[i], 1);
+			if (ret)
+				break;
+		}
+	}
+
+	/* A short transfer comes back as -EIO: some of the writes were lost */
+	if (ret) {
+		dev_err(&client->dev, "Failed to write %u-message batch at 0x%04x: %d\n",
+			b->nmsgs, get_unaligned_be16(b->msgs[0].buf), ret);
+		return ret;
+	}
+
+	b->nmsgs = 0;
+	b->used = 0;
+	return 0;
+}
 
-	ret = i2c_master_send(client, buf, 3);
-	if (ret < 0) {
-		dev_err(&client->dev, "Failed to write reg 0x%04x: %d\n", reg, ret);
+/* Send what is queued, then give a soft reset its settle time */
+static int gc2607_batch_finish(struct gc2607 *gc2607, struct gc2607_batch *b)
+{
+	int ret;
+
+	ret = gc2607_batch_flush(gc2607, b);
+	if (ret)
 		return ret;
+
+	if (b->reset) {
+		fsleep(GC2607_SOFT_RESET_US);
+		b->reset = false;
+	}
+
+	return 0;
+}
+
+static int gc2607_batch_add(struct gc2607 *gc2607, struct gc2607_batch *b,
+			    u16 reg, u8 val)
+{
+	struct i2c_msg *msg;
+	int ret;
+
+	/* Soft reset writes travel alone; the first write after them waits */
+	if (reg == GC2607_REG_SOFT_RESET || b->reset) {
+		if (reg == GC2607_REG_SOFT_RESET)
+			ret = gc2607_batch_flush(gc2607, b);
+		else
+			ret = gc2607_batch_finish(gc2607, b);
+		if (ret)
+			return ret;
+	}
+
+	msg = b->nmsgs ? &b->msgs[b->nmsgs - 1] : NULL;
+
+	/* Extend the open burst if this register follows on from it */
+	if (msg && reg == b->next_addr && msg->len - 2 < GC2607_BURST_MAX &&
+	    b->used < GC2607_BATCH_BUF_SIZE) {
+		b->buf[b->used++] = val;
+		msg->len++;
+		b->next_addr++;
+		return 0;
+	}
+
+	/* Otherwise start a new message, flushing first if the batch is full */
+	if (b->nmsgs == GC2607_BATCH_MSGS || b->used + 3 > GC2607_BATCH_BUF_SIZE) {
+		ret = gc2607_batch_flush(gc2607, b);
+		if (ret)
+			return ret;
+	}
+
+	msg = &b->msgs[b->nmsgs++];
+	msg->addr = gc2607->client->addr;
+	msg->flags = 0;
+	msg->len = 3;
+	msg->buf = &b->buf[b->used];
+	put_unaligned_be16(reg, msg->buf);
+	msg->buf[2] = val;
+	b->used += 3;
+	b->next_addr = reg + 1;
+	if (reg == GC2607_REG_SOFT_RESET) {
+		b->reset = true;
+		b->next_addr = GC2607_REG_END;	/* Never extended */
 	}
 
 	return 0;
 }
 
 /*
- * Write an array of registers
+ * Write an array of registers directly to the sensor, in table order
  * Handles special markers: GC2607_REG_DELAY for delays, GC2607_REG_END for end
+ *
+ * Table order is preserved: repeated writes to the same register (soft reset
+ * 0x03fe) stay separate transfers, and a delay marker flushes everything
+ * queued before it so the sleep happens at the same point on the bus.
  */
 static int gc2607_write_array(struct gc2607 *gc2607,
 			       const struct gc2607_regval *regs)
 {
 	struct i2c_client *client = gc2607->client;
+	struct gc2607_batch batch = {};
+	u32 xfers = gc2607->xfer_count;
+	u32 bytes = gc2607->xfer_bytes;
+	ktime_t start = ktime_get();
 	int ret = 0;
 	u32 i;
 
 	for (i = 0; regs[i].addr != GC2607_REG_END; i++) {
 		if (regs[i].addr == GC2607_REG_DELAY) {
+			ret = gc2607_batch_finish(gc2607, &batch);
+			if (ret)
+				return ret;
 			msleep(regs[i].val);
 		} else {
-			ret = gc2607_write_reg(gc2607, regs[i].addr, regs[i].val);
-			if (ret < 0) {
-				dev_err(&client->dev,
-					"Failed to write reg 0x%04x at index %u: %d\n",
-					regs[i].addr, i, ret);
+			ret = gc2607_batch_add(gc2607, &batch, regs[i].addr,
+					       regs[i].val);
+			if (ret)
 				return ret;
-			}
 		}
 	}
 
-	dev_info(&client->dev, "Wrote %u registers successfully\n", i);
+	ret = gc2607_batch_finish(gc2607, &batch);
+	if (ret)
+		return ret;
+
+	trace_gc2607_write_array(&client->dev, i, gc2607->xfer_count - xfers,
+				 gc2607->xfer_bytes - bytes,
+				 ktime_us_delta(ktime_get(), start));
+	dev_dbg(&client->dev, "Wrote %u registers in %u I2C transfers\n",
+		i, gc2607->xfer_count - xfers);
 	return 0;
 }
 
 /*
- * Register initialization sequence for 1920x1080@30fps MIPI mode
- * Extracted from reference driver gc2607_init_regs_1920_1080_30fps_mipi[]
- */
-static const struct gc2607_regval gc2607_1080p_30fps_regs[] = {
-	{0x03fe, 0xf0},
-	{0x03fe, 0xf0},
-	{0x03fe, 0x00},
-	{0x03fe, 0x00},
-	{0x03fe, 0x00},
-	{0x03fe, 0x00},
-	{0x0d06, 0x01},
-	{0x0315, 0xd4},
-	{0x0d82, 0x14},
-	{0x0a70, 0x80},
-	{0x0134, 0x5b},
-	{0x0110, 0x01},
-	{0x0dd1, 0x56},
-	{0x0137, 0x03},
-	{0x0135, 0x01},
-	{0x0136, 0x2a},
-	{0x0130, 0x08},
-	{0x0132, 0x01},
-	{0x031c, 0x93},
-	{0x0218, 0x00},
-	{0x0340, 0x0a},
-	{0x0341, 0x6e},
-	{0x0342, 0x08},  /* HTS high byte */
-	{0x0343, 0x00},  /* HTS low byte = 2048 */
-	{0x0220, 0x07},  /* VTS high byte (2003 = 0x07d3 for 20 FPS) */
-	{0x0221, 0xd3},  /* VTS low byte */
-	{0x0af4, 0x2b},
-	{0x0002, 0x30},
-	{0x00c3, 0x3c},
-	{0x0101, 0x00},
-	{0x0d05, 0xcc},
-	{0x0218, 0x00},
-	{0x005e, 0x84},
-	{0x0007, 0x15},
-	{0x0350, 0x01},
-	{0x00c0, 0x07},
-	{0x00c1, 0x90},
-	{0x0346, 0x00},
-	{0x0347, 0x02},
-	{0x034a, 0x04},
-	{0x034b, 0x40},
-	{0x021f, 0x12},
-	{0x034c, 0x07},
-	{0x034d, 0x80},
-	{0x0353, 0x00},
-	{0x0354, 0x04},
-	{0x0d11, 0x10},
-	{0x0d22, 0x00},
-	{0x03f6, 0x4d},
-	{0x03f5, 0x3c},
-	{0x03f3, 0x54},
-	{0x0d07, 0xdd},
-	{0x0e71, 0x00},
-	{0x0e72, 0x10},
-	{0x0e17, 0x26},
-	{0x0e22, 0x0d},
-	{0x0e23, 0x20},
-	{0x0e1b, 0x30},
-	{0x0e3a, 0x15},
-	{0x0e0a, 0x00},
-	{0x0e0b, 0x00},
-	{0x0e0e, 0x00},
-	{0x0e2a, 0x08},
-	{0x0e2b, 0x08},
-	{0x0d02, 0x73},
-	{0x0d22, 0x38},
-	{0x0d25, 0x00},
-	{0x0e6a, 0x39},
-	{0x0050, 0x05},
-	{0x0089, 0x03},
-	{0x0070, 0x40},
-	{0x0071, 0x40},
-	{0x0072, 0x40},
-	{0x0073, 0x40},
-	{0x0040, 0x82},
-	{0x0030, 0x80},
-	{0x0031, 0x80},
-	{0x0032, 0x80},
-	{0x0033, 0x80},
-	{0x0202, 0x04},  /* Exposure high byte */
-	{0x0203, 0x38},  /* Exposure low byte = 1080 */
-	{0x02b3, 0x00},
-	{0x02b3, 0x00},
-	{0x02b4, 0x00},
-	{0x0208, 0x04},
-	{0x0209, 0x00},
-	{0x009e, 0x01},
-	{0x009f, 0xa0},
-	{0x0db8, 0x08},
-	{0x0db6, 0x02},
-	{0x0db4, 0x05},
-	{0x0db5, 0x16},
-	{0x0db9, 0x09},
-	{0x0d93, 0x05},
-	{0x0d94, 0x06},
-	{0x0d95, 0x0b},
-	{0x0d99, 0x10},
-	{0x0082, 0x03},
-	{0x0107, 0x05},
-	{0x0117, 0x01},
-	{0x0d80, 0x07},
-	{0x0d81, 0x02},
-	{0x0d84, 0x09},
-	{0x0d85, 0x60},
-	{0x0d86, 0x04},
-	{0x0d87, 0xb1},
-	{0x0222, 0x00},
-	{0x0223, 0x01},
-	{0x0117, 0x91},
-	{0x03f4, 0x38},
-	{0x0e69, 0x00},
-	{0x00d6, 0x00},
-	{0x00d0, 0x0d},
-	{0x00e0, 0x18},
-	{0x00e1, 0x18},
-	{0x00e2, 0x18},
-	{0x00e3, 0x18},
-	{0x00e4, 0x18},
-	{0x00e5, 0x18},
-	{0x00e6, 0x18},
-	{0x00e7, 0x18},
+ * Stream on/off sequences, the gc2607_stream_on_mipi/gc2607_stream_off_mipi
+ * hooks the reference driver leaves empty. Stream on is the final 0x0117
+ * write of the init table, which compile_regs.py leaves out of the compiled
+ * sequence; stream off returns 0x0117 to the value the init segments hold
+ * it at while the registers are programmed.
+ */
+static const struct gc2607_regval gc2607_stream_on_regs[] = {
+	{GC2607_REG_MIPI_CTRL, GC2607_MIPI_STREAM_ON},
+	{GC2607_REG_END, 0x00},
+};
+
+static const struct gc2607_regval gc2607_stream_off_regs[] = {
+	{GC2607_REG_MIPI_CTRL, GC2607_MIPI_STREAM_OFF},
 	{GC2607_REG_END, 0x00},
 };
 
-/* Supported sensor modes */
+/* Link frequency menu items */
+static const s64 gc2607_link_freqs[] = {
+	GC2607_LINK_FREQ,
+};
+
+/*
+ * Supported sensor modes, largest first. The sensor has no binning, so a
+ * smaller output is a crop set through the selection API rather than a
+ * mode. A mode only earns an entry with timing of its own: no frame
+ * length shorter than the 30 fps of the reference gc2607_set_fps() (VTS
+ * 1335) has been measured, so 1080p is the only one.
+ */
 static const struct gc2607_mode gc2607_modes[] = {
 	{
 		.width = GC2607_WIDTH,
@@ -359,25 +777,208 @@ static const struct gc2607_mode gc2607_modes[] = {
 		.hts = GC2607_HTS,
 		.vts = GC2607_VTS,
 		.max_fps = 30,
-		.reg_list = gc2607_1080p_30fps_regs,
+		.link_freq_index = 0,
+		.pixel_rate = GC2607_PIXEL_RATE,
+		.crop = { 0, 0, GC2607_WIDTH, GC2607_HEIGHT },
 	},
 };
 
-/* Link frequency menu items */
-static const s64 gc2607_link_freqs[] = {
-	GC2607_LINK_FREQ,
-};
+/*
+ * Register cache management
+ */
+
+/* Walk compiled init segments: length, 16-bit start address, values */
+#define gc2607_for_each_seg(seg, segs) \
+	for (seg = segs; seg[0]; seg += 3 + seg[0])
+
+/*
+ * Load a register table into the cache without touching the sensor.
+ * Volatile registers are skipped, as they are written by the init
+ * segments, gc2607_stream_on_regs or the controls instead.
+ */
+static int gc2607_cache_array(struct gc2607 *gc2607,
+			      const struct gc2607_regval *regs)
+{
+	struct device *dev = &gc2607->client->dev;
+	int ret = 0;
+	u32 i;
+
+	regcache_cache_only(gc2607->regmap, true);
+
+	for (i = 0; regs[i].addr != GC2607_REG_END; i++) {
+		if (regs[i].addr == GC2607_REG_DELAY ||
+		    gc2607_volatile_reg(dev, regs[i].addr))
+			continue;
+
+		ret = regmap_write(gc2607->regmap, regs[i].addr, regs[i].val);
+		if (ret) {
+			dev_err(dev, "Failed to cache reg 0x%04x: %d\n",
+				regs[i].addr, ret);
+			break;
+		}
+	}
+
+	regcache_cache_only(gc2607->regmap, !gc2607->powered);
+	return ret;
+}
+
+/* Load the readout window for @crop into the cache */
+static int gc2607_cache_window(struct gc2607 *gc2607,
+			       const struct v4l2_rect *crop)
+{
+	u32 row_start = GC2607_ROW_START + crop->top;
+	u32 rows = crop->height + GC2607_ROW_MARGIN;
+	u32 col_start = GC2607_COL_START + crop->left;
+	u32 line = crop->width * 10 / 8;
+	const struct gc2607_regval regs[] = {
+		{GC2607_REG_ROW_START_H, row_start >> 8},
+		{GC2607_REG_ROW_START_L, row_start & 0xff},
+		{GC2607_REG_ROW_COUNT_H, rows >> 8},
+		{GC2607_REG_ROW_COUNT_L, rows & 0xff},
+		{GC2607_REG_COL_COUNT_H, crop->width >> 8},
+		{GC2607_REG_COL_COUNT_L, crop->width & 0xff},
+		{GC2607_REG_COL_START_H, col_start >> 8},
+		{GC2607_REG_COL_START_L, col_start & 0xff},
+		{GC2607_REG_MIPI_LINE_H, line >> 8},
+		{GC2607_REG_MIPI_LINE_L, line & 0xff},
+		{GC2607_REG_MIPI_HALF_H, (line / 2 + 1) >> 8},
+		{GC2607_REG_MIPI_HALF_L, (line / 2 + 1) & 0xff},
+		{GC2607_REG_END, 0x00},
+	};
+
+	return gc2607_cache_array(gc2607, regs);
+}
+
+/* The readout window, held in the cache for the current crop */
+static bool gc2607_window_reg(unsigned int reg)
+{
+	switch (reg) {
+	case GC2607_REG_ROW_START_H:
+	case GC2607_REG_ROW_START_L:
+	case GC2607_REG_ROW_COUNT_H:
+	case GC2607_REG_ROW_COUNT_L:
+	case GC2607_REG_COL_COUNT_H:
+	case GC2607_REG_COL_COUNT_L:
+	case GC2607_REG_COL_START_H:
+	case GC2607_REG_COL_START_L:
+	case GC2607_REG_MIPI_LINE_H:
+	case GC2607_REG_MIPI_LINE_L:
+	case GC2607_REG_MIPI_HALF_H:
+	case GC2607_REG_MIPI_HALF_L:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Write compiled init segments in table order, every register of them,
+ * with the window of the current crop from the cache in place of the
+ * table's. Every message goes through the batcher, which keeps the soft
+ * reset writes apart, so the whole table takes a handful of transfers.
+ */
+static int gc2607_write_segs(struct gc2607 *gc2607, const u8 *segs)
+{
+	struct gc2607_batch batch = {};
+	unsigned int i, reg, val;
+	const u8 *seg;
+	int ret;
+
+	gc2607_for_each_seg(seg, segs) {
+		reg = get_unaligned_be16(seg + 1);
+
+		for (i = 0; i < seg[0]; i++) {
+			val = seg[3 + i];
+			if (gc2607_window_reg(reg + i)) {
+				/* Non-volatile, so this is a cache lookup */
+				ret = regmap_read(gc2607->regmap, reg + i, &val);
+				if (ret)
+					return ret;
+			}
+
+			ret = gc2607_batch_add(gc2607, &batch, reg + i, val);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return gc2607_batch_finish(gc2607, &batch);
+}
+
+/*
+ * Soft-reset the sensor and write the init registers up to the stream
+ * enable; the soft reset is the start of gc2607_init_segs.
+ */
+static int gc2607_sync_regs(struct gc2607 *gc2607)
+{
+	struct device *dev = &gc2607->client->dev;
+	u32 xfers = gc2607->xfer_count;
+	u32 bytes = gc2607->xfer_bytes;
+	ktime_t start = ktime_get();
+	int ret;
+
+	ret = gc2607_write_segs(gc2607, gc2607_init_segs);
+	if (ret) {
+		dev_err(dev, "Failed to write init registers: %d\n", ret);
+		return ret;
+	}
+
+	trace_gc2607_init_regs(dev, gc2607->xfer_count - xfers,
+			       gc2607->xfer_bytes - bytes,
+			       ktime_us_delta(ktime_get(), start));
+	dev_info(dev, "Init registers written in %u I2C transfers\n",
+		 gc2607->xfer_count - xfers);
+	return 0;
+}
 
 /*
  * Power management
  */
+
+/*
+ * Platforms can override any of these through the firmware properties in
+ * docs/firmware-properties.md, e.g. from a software node added by
+ * ipu-bridge or an ACPI _DSD. The values are also writable in debugfs for
+ * tuning.
+ */
+static void gc2607_get_power_timing(struct gc2607 *gc2607)
+{
+	struct device *dev = &gc2607->client->dev;
+	struct gc2607_power_timing *t = &gc2607->timing;
+
+	*t = gc2607_default_timing;
+	device_property_read_u32(dev, "galaxycore,t-supply-us", &t->supply_us);
+	device_property_read_u32(dev, "galaxycore,t-clk-to-reset-us",
+				 &t->clk_to_reset_us);
+	device_property_read_u32(dev, "galaxycore,t-pre-reset-us",
+				 &t->pre_reset_us);
+	device_property_read_u32(dev, "galaxycore,t-reset-us", &t->reset_us);
+	device_property_read_u32(dev, "galaxycore,t-post-reset-us",
+				 &t->post_reset_us);
+	device_property_read_u32(dev, "galaxycore,t-powerdown-us",
+				 &t->powerdown_us);
+	device_property_read_u32(dev, "galaxycore,t-boot-us", &t->boot_us);
+
+	dev_dbg(dev, "Power timing: supply %u us, clk %u us, reset %u/%u/%u us, powerdown %u us, boot %u us\n",
+		t->supply_us, t->clk_to_reset_us, t->pre_reset_us,
+		t->reset_us, t->post_reset_us, t->powerdown_us, t->boot_us);
+}
+
 static int gc2607_power_on(struct gc2607 *gc2607)
 {
 	struct i2c_client *client = gc2607->client;
+	const struct gc2607_power_timing *t = &gc2607->timing;
+	ktime_t start = ktime_get();
 	int ret;
 
+	gc2607_stub_redirect(gc2607_power_on, gc2607);
+
 	dev_info(&client->dev, "%s: Powering on sensor\n", __func__);
 
+	/* Hold the sensor in reset while supplies and clock come up */
+	if (gc2607->reset_gpio)
+		gpiod_set_value_cansleep(gc2607->reset_gpio, 1);
+
 	/* Enable regulators if available */
 	if (gc2607->supplies[0].supply) {
 		ret = regulator_bulk_enable(ARRAY_SIZE(gc2607->supplies),
@@ -387,7 +988,7 @@ static int gc2607_power_on(struct gc2607 *gc2607)
 			return ret;
 		}
 		dev_dbg(&client->dev, "Regulators enabled\n");
-		usleep_range(5000, 6000);
+		fsleep(t->supply_us);
 	}
 
 	/* Enable master clock if available */
@@ -398,96 +999,282 @@ static int gc2607_power_on(struct gc2607 *gc2607)
 			goto err_reg;
 		}
 		dev_dbg(&client->dev, "Clock enabled\n");
-		usleep_range(5000, 6000);
+		fsleep(t->clk_to_reset_us);
 	}
 
+	/* Leave power-down; the sensor is still held in reset */
+	if (gc2607->powerdown_gpio)
+		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 0);
+
 	/*
 	 * Reset sequence from reference driver (gc2607.c:689-694):
 	 * Physical: HIGH (20ms) → LOW (20ms) → HIGH (10ms)
 	 *
-	 * For gpiod API with active-low GPIO (GPIOD_OUT_LOW):
+	 * For gpiod API with active-low GPIO:
 	 * - gpiod_set_value(0) = de-assert = physical HIGH = running
 	 * - gpiod_set_value(1) = assert = physical LOW = reset
 	 */
 	if (gc2607->reset_gpio) {
-		/* Start: de-asserted (running) */
 		gpiod_set_value_cansleep(gc2607->reset_gpio, 0);
-		msleep(20);
-
-		/* Assert reset (put sensor into reset) */
+		fsleep(t->pre_reset_us);
 		gpiod_set_value_cansleep(gc2607->reset_gpio, 1);
-		msleep(20);
-
-		/* De-assert reset (release from reset, sensor boots) */
+		fsleep(t->reset_us);
 		gpiod_set_value_cansleep(gc2607->reset_gpio, 0);
-		msleep(10);
-
+		fsleep(t->post_reset_us);
 		dev_dbg(&client->dev, "Reset pulse completed\n");
 	}
 
-	/*
-	 * Powerdown sequence from reference driver (gc2607.c:702-707):
-	 * If present, pulse the powerdown GPIO
-	 * Assuming active-high powerdown (high = powered down)
-	 */
+	/* Power-down pulse from reference driver (gc2607.c:702-707) */
 	if (gc2607->powerdown_gpio) {
-		/* Power down */
 		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 1);
-		msleep(10);
+		fsleep(t->powerdown_us);
+		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 0);
+		fsleep(t->powerdown_us);
+		dev_dbg(&client->dev, "Powerdown pulse completed\n");
+	}
+
+	/* Wait for sensor to fully boot */
+	fsleep(t->boot_us);
+
+	gc2607->powered = true;
+	gc2607->power_on_us = ktime_us_delta(ktime_get(), start);
+	trace_gc2607_power_on(&client->dev, gc2607->power_on_us);
+	gc2607_stat_add(&gc2607->stats.power_on, gc2607->power_on_us, 0);
+	dev_info(&client->dev, "Sensor powered on in %llu us\n",
+		 gc2607->power_on_us);
+
+	return 0;
+
+err_reg:
+	if (gc2607->supplies[0].supply)
+		regulator_bulk_disable(ARRAY_SIZE(gc2607->supplies), gc2607->supplies);
+	return ret;
+}
+
+static void gc2607_power_off(struct gc2607 *gc2607)
+{
+	struct i2c_client *client = gc2607->client;
+	ktime_t start = ktime_get();
+	s64 us;
+
+	gc2607_stub_redirect(gc2607_power_off, gc2607);
+
+	dev_info(&client->dev, "%s: Powering off sensor\n", __func__);
+
+	if (!gc2607->powered)
+		return;
+
+	/* Assert reset if GPIO exists */
+	if (gc2607->reset_gpio)
+		gpiod_set_value_cansleep(gc2607->reset_gpio, 1);
+
+	/* Assert power-down if GPIO exists */
+	if (gc2607->powerdown_gpio)
+		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 1);
+
+	/* Disable master clock if available */
+	if (gc2607->xclk)
+		clk_disable_unprepare(gc2607->xclk);
+
+	/* Disable regulators if available */
+	if (gc2607->supplies[0].supply)
+		regulator_bulk_disable(ARRAY_SIZE(gc2607->supplies), gc2607->supplies);
+
+	gc2607->powered = false;
+	us = ktime_us_delta(ktime_get(), start);
+	trace_gc2607_power_off(&client->dev, us);
+	gc2607_stat_add(&gc2607->stats.power_off, us, 0);
+	dev_info(&client->dev, "Sensor powered off\n");
+}
+
+/*
+ * Power-cycle the sensor after a failure the I2C retries did not clear,
+ * as a runtime suspend and resume would, keeping the caller's runtime PM
+ * reference. The registers are reprogrammed from the cache afterwards.
+ */
+static int gc2607_power_cycle(struct gc2607 *gc2607)
+{
+	int ret;
+
+	gc2607->regs_valid = false;
+	regcache_cache_only(gc2607->regmap, true);
+
+	gc2607_power_off(gc2607);
+	ret = gc2607_power_on(gc2607);
+	if (ret)
+		return ret;
+
+	regcache_cache_only(gc2607->regmap, false);
+	return 0;
+}
+
+/* Exposure must stay below the frame length, @height + @vblank */
+static int gc2607_update_exposure_range(struct gc2607 *gc2607, u32 height,
+					u32 vblank)
+{
+	u32 exposure_max = height + vblank - 1;
+
+	return __v4l2_ctrl_modify_range(gc2607->exposure, GC2607_EXPOSURE_MIN,
+					exposure_max, GC2607_EXPOSURE_STEP,
+					min_t(u32, exposure_max,
+					      GC2607_EXPOSURE_DEFAULT));
+}
+
+/* Bayer order of the readout with the current flips */
+static u32 gc2607_bayer_code(struct gc2607 *gc2607)
+{
+	static const u32 codes[2][2] = {
+		/* [vflip][hflip] */
+		{ MEDIA_BUS_FMT_SGRBG10_1X10, MEDIA_BUS_FMT_SRGGB10_1X10 },
+		{ MEDIA_BUS_FMT_SBGGR10_1X10, MEDIA_BUS_FMT_SGBRG10_1X10 },
+	};
+
+	return codes[gc2607->vflip->val][gc2607->hflip->val];
+}
+
+/*
+ * The active crop. The subdev state lock is the control handler lock, so
+ * this is valid from s_ctrl as well as from the pad operations.
+ */
+static const struct v4l2_rect *gc2607_active_crop(struct gc2607 *gc2607)
+{
+	struct v4l2_subdev_state *state;
+
+	state = v4l2_subdev_get_locked_active_state(&gc2607->sd);
+	return v4l2_subdev_state_get_crop(state, 0);
+}
+
+/* The smallest mode, and so the fastest timing, that still covers @crop */
+static const struct gc2607_mode *
+gc2607_find_mode(const struct v4l2_rect *crop)
+{
+	unsigned int i = ARRAY_SIZE(gc2607_modes) - 1;
+
+	while (i && (gc2607_modes[i].width < crop->width ||
+		     gc2607_modes[i].height < crop->height))
+		i--;
+
+	return &gc2607_modes[i];
+}
+
+/* Frame interval = HTS x VTS / pixel rate, reduced to lowest terms */
+static void gc2607_vts_to_interval(const struct gc2607_mode *mode, u32 vts,
+				   struct v4l2_fract *interval)
+{
+	u64 num = (u64)mode->hts * vts;
+	u64 den = mode->pixel_rate;
+	u64 div = gcd(num, den);
+
+	interval->numerator = num / div;
+	interval->denominator = den / div;
+}
+
+/*
+ * Move the timing controls to the limits of the mode that reads out
+ * @crop, with the frame length reset to the mode's default. Called with
+ * the active state, and so the control handler, locked.
+ */
+static int gc2607_update_timing(struct gc2607 *gc2607,
+				const struct v4l2_rect *crop)
+{
+	const struct gc2607_mode *mode = gc2607_find_mode(crop);
+	u32 hblank = mode->hts - crop->width;
+	u32 vblank_def = mode->vts - crop->height;
+	int ret;
 
-		/* Power up */
-		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 0);
-		msleep(10);
+	ret = __v4l2_ctrl_s_ctrl(gc2607->link_freq, mode->link_freq_index);
+	if (ret)
+		return ret;
 
-		dev_dbg(&client->dev, "Powerdown pulse completed\n");
-	}
+	ret = __v4l2_ctrl_modify_range(gc2607->pixel_rate, mode->pixel_rate,
+				       mode->pixel_rate, 1, mode->pixel_rate);
+	if (ret)
+		return ret;
 
-	/* Wait for sensor to fully boot */
-	msleep(20);
+	ret = __v4l2_ctrl_modify_range(gc2607->hblank, hblank, hblank, 1,
+				       hblank);
+	if (ret)
+		return ret;
 
-	gc2607->powered = true;
-	dev_info(&client->dev, "Sensor powered on\n");
+	ret = __v4l2_ctrl_modify_range(gc2607->vblank,
+				       gc2607_vts_min(mode) - crop->height,
+				       GC2607_VTS_MAX - crop->height, 1,
+				       vblank_def);
+	if (ret)
+		return ret;
 
-	return 0;
+	ret = __v4l2_ctrl_s_ctrl(gc2607->vblank, vblank_def);
+	if (ret)
+		return ret;
 
-err_reg:
-	if (gc2607->supplies[0].supply)
-		regulator_bulk_disable(ARRAY_SIZE(gc2607->supplies), gc2607->supplies);
-	return ret;
+	/* s_ctrl is skipped if VBLANK kept its value; the height still changed */
+	return gc2607_update_exposure_range(gc2607, crop->height, vblank_def);
 }
 
-static void gc2607_power_off(struct gc2607 *gc2607)
+/*
+ * Store @crop, and the format of the same size, in @sd_state. For the
+ * active state the window is also loaded into the register cache, to reach
+ * the sensor at the next full initialization (which clearing regs_valid
+ * forces), and the timing controls follow it. TRY states are left without
+ * side effects.
+ */
+static int gc2607_set_crop(struct gc2607 *gc2607,
+			   struct v4l2_subdev_state *sd_state, u32 which,
+			   const struct v4l2_rect *crop)
 {
-	struct i2c_client *client = gc2607->client;
+	struct v4l2_rect *state_crop = v4l2_subdev_state_get_crop(sd_state, 0);
+	struct v4l2_mbus_framefmt *fmt = v4l2_subdev_state_get_format(sd_state, 0);
+	const struct gc2607_mode *mode = gc2607_find_mode(crop);
+	int ret;
 
-	dev_info(&client->dev, "%s: Powering off sensor\n", __func__);
+	if (v4l2_rect_equal(crop, state_crop))
+		return 0;
 
-	if (!gc2607->powered)
-		return;
+	if (which == V4L2_SUBDEV_FORMAT_ACTIVE) {
+		if (gc2607->streaming)
+			return -EBUSY;
 
-	/* Assert reset if GPIO exists */
-	if (gc2607->reset_gpio)
-		gpiod_set_value_cansleep(gc2607->reset_gpio, 0);
+		ret = gc2607_cache_window(gc2607, crop);
+		if (ret)
+			return ret;
 
-	/* Assert power-down if GPIO exists */
-	if (gc2607->powerdown_gpio)
-		gpiod_set_value_cansleep(gc2607->powerdown_gpio, 1);
+		gc2607->regs_valid = false;
+	}
 
-	/* Disable master clock if available */
-	if (gc2607->xclk)
-		clk_disable_unprepare(gc2607->xclk);
+	*state_crop = *crop;
+	fmt->width = crop->width;
+	fmt->height = crop->height;
+	gc2607_vts_to_interval(mode, mode->vts,
+			       v4l2_subdev_state_get_interval(sd_state, 0));
 
-	/* Disable regulators if available */
-	if (gc2607->supplies[0].supply)
-		regulator_bulk_disable(ARRAY_SIZE(gc2607->supplies), gc2607->supplies);
+	if (which == V4L2_SUBDEV_FORMAT_ACTIVE)
+		return gc2607_update_timing(gc2607, crop);
 
-	gc2607->powered = false;
-	dev_info(&client->dev, "Sensor powered off\n");
+	return 0;
 }
 
 /*
  * V4L2 subdev pad operations
  */
+static int gc2607_init_state(struct v4l2_subdev *sd,
+			     struct v4l2_subdev_state *sd_state)
+{
+	const struct gc2607_mode *mode = &gc2607_modes[0];
+	struct v4l2_mbus_framefmt *fmt = v4l2_subdev_state_get_format(sd_state, 0);
+
+	fmt->width = mode->width;
+	fmt->height = mode->height;
+	fmt->code = gc2607_bayer_code(to_gc2607(sd));
+	fmt->field = V4L2_FIELD_NONE;
+	fmt->colorspace = V4L2_COLORSPACE_RAW;
+
+	*v4l2_subdev_state_get_crop(sd_state, 0) = mode->crop;
+	gc2607_vts_to_interval(mode, mode->vts,
+			       v4l2_subdev_state_get_interval(sd_state, 0));
+
+	return 0;
+}
+
 static int gc2607_enum_mbus_code(struct v4l2_subdev *sd,
 				  struct v4l2_subdev_state *sd_state,
 				  struct v4l2_subdev_mbus_code_enum *code)
@@ -495,7 +1282,7 @@ static int gc2607_enum_mbus_code(struct v4l2_subdev *sd,
 	if (code->index > 0)
 		return -EINVAL;
 
-	code->code = MEDIA_BUS_FMT_SGRBG10_1X10;
+	code->code = gc2607_bayer_code(to_gc2607(sd));
 	return 0;
 }
 
@@ -506,7 +1293,7 @@ static int gc2607_enum_frame_size(struct v4l2_subdev *sd,
 	if (fse->index >= ARRAY_SIZE(gc2607_modes))
 		return -EINVAL;
 
-	if (fse->code != MEDIA_BUS_FMT_SGRBG10_1X10)
+	if (fse->code != gc2607_bayer_code(to_gc2607(sd)))
 		return -EINVAL;
 
 	fse->min_width = gc2607_modes[fse->index].width;
@@ -517,149 +1304,446 @@ static int gc2607_enum_frame_size(struct v4l2_subdev *sd,
 	return 0;
 }
 
-static int gc2607_get_fmt(struct v4l2_subdev *sd,
+static int gc2607_set_fmt(struct v4l2_subdev *sd,
 			   struct v4l2_subdev_state *sd_state,
 			   struct v4l2_subdev_format *format)
 {
 	struct gc2607 *gc2607 = to_gc2607(sd);
 	struct v4l2_mbus_framefmt *mbus_fmt = &format->format;
+	const struct v4l2_rect *crop = v4l2_subdev_state_get_crop(sd_state, 0);
+	const struct gc2607_mode *mode;
+	int ret;
+
+	/*
+	 * There is no scaler: the format is the crop size. Keep a crop set
+	 * through the selection API if its size is asked for again, otherwise
+	 * switch to the nearest mode's crop.
+	 */
+	if (mbus_fmt->width != crop->width || mbus_fmt->height != crop->height) {
+		mode = v4l2_find_nearest_size(gc2607_modes,
+					      ARRAY_SIZE(gc2607_modes),
+					      width, height,
+					      mbus_fmt->width, mbus_fmt->height);
+		crop = &mode->crop;
+	}
 
-	/* Only support ACTIVE format (TRY not implemented) */
-	mbus_fmt->width = gc2607->cur_mode->width;
-	mbus_fmt->height = gc2607->cur_mode->height;
-	mbus_fmt->code = MEDIA_BUS_FMT_SGRBG10_1X10;
-	mbus_fmt->field = V4L2_FIELD_NONE;
-	mbus_fmt->colorspace = V4L2_COLORSPACE_RAW;
+	ret = gc2607_set_crop(gc2607, sd_state, format->which, crop);
+	if (ret)
+		return ret;
 
+	/* A TRY state may have been set up under other flips */
+	v4l2_subdev_state_get_format(sd_state, 0)->code =
+		gc2607_bayer_code(gc2607);
+	*mbus_fmt = *v4l2_subdev_state_get_format(sd_state, 0);
 	return 0;
 }
 
-static int gc2607_set_fmt(struct v4l2_subdev *sd,
-			   struct v4l2_subdev_state *sd_state,
-			   struct v4l2_subdev_format *format)
+/*
+ * Selection: the crop bounds are the 1920x1080 area of the 1080p mode. A
+ * crop is read out by the sensor's window registers, so only its own
+ * pixels cross the bus; the format follows the crop size.
+ */
+static int gc2607_get_selection(struct v4l2_subdev *sd,
+				struct v4l2_subdev_state *sd_state,
+				struct v4l2_subdev_selection *sel)
+{
+	if (sel->pad)
+		return -EINVAL;
+
+	switch (sel->target) {
+	case V4L2_SEL_TGT_CROP:
+		sel->r = *v4l2_subdev_state_get_crop(sd_state, 0);
+		return 0;
+
+	case V4L2_SEL_TGT_NATIVE_SIZE:
+	case V4L2_SEL_TGT_CROP_BOUNDS:
+	case V4L2_SEL_TGT_CROP_DEFAULT:
+		sel->r = gc2607_modes[0].crop;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+static int gc2607_set_selection(struct v4l2_subdev *sd,
+				struct v4l2_subdev_state *sd_state,
+				struct v4l2_subdev_selection *sel)
 {
 	struct gc2607 *gc2607 = to_gc2607(sd);
-	struct v4l2_mbus_framefmt *mbus_fmt = &format->format;
-	const struct gc2607_mode *mode;
+	struct v4l2_rect *r = &sel->r;
+
+	if (sel->pad || sel->target != V4L2_SEL_TGT_CROP)
+		return -EINVAL;
+
+	/* Even offsets keep GRBG; whole RAW10 pixel groups per line */
+	r->width = clamp_t(u32, ALIGN(r->width, GC2607_CROP_WIDTH_ALIGN),
+			   GC2607_CROP_MIN_WIDTH, GC2607_WIDTH);
+	r->height = clamp_t(u32, ALIGN(r->height, GC2607_CROP_HEIGHT_ALIGN),
+			    GC2607_CROP_MIN_HEIGHT, GC2607_HEIGHT);
+	r->left = ALIGN_DOWN(clamp_t(s32, r->left, 0, GC2607_WIDTH - r->width),
+			     2);
+	r->top = ALIGN_DOWN(clamp_t(s32, r->top, 0, GC2607_HEIGHT - r->height),
+			    2);
+
+	return gc2607_set_crop(gc2607, sd_state, sel->which, r);
+}
+
+/*
+ * The active frame interval is derived from VBLANK; TRY intervals are
+ * kept in the state.
+ */
+static int gc2607_get_frame_interval(struct v4l2_subdev *sd,
+				     struct v4l2_subdev_state *sd_state,
+				     struct v4l2_subdev_frame_interval *fi)
+{
+	struct gc2607 *gc2607 = to_gc2607(sd);
+	const struct v4l2_rect *crop = v4l2_subdev_state_get_crop(sd_state, 0);
+
+	if (fi->pad)
+		return -EINVAL;
+
+	if (fi->which == V4L2_SUBDEV_FORMAT_TRY) {
+		fi->interval = *v4l2_subdev_state_get_interval(sd_state, 0);
+		return 0;
+	}
+
+	gc2607_vts_to_interval(gc2607_find_mode(crop),
+			       crop->height + gc2607->vblank->val, &fi->interval);
+	return 0;
+}
+
+/*
+ * Pick the frame length closest to the requested interval and program it
+ * through V4L2_CID_VBLANK, which also rescales the exposure range.
+ */
+static int gc2607_set_frame_interval(struct v4l2_subdev *sd,
+				     struct v4l2_subdev_state *sd_state,
+				     struct v4l2_subdev_frame_interval *fi)
+{
+	struct gc2607 *gc2607 = to_gc2607(sd);
+	const struct v4l2_rect *crop = v4l2_subdev_state_get_crop(sd_state, 0);
+	const struct gc2607_mode *mode = gc2607_find_mode(crop);
+	u64 vts;
+	int ret;
 
-	/* Only support the default mode */
-	mode = &gc2607_modes[0];
+	if (fi->pad)
+		return -EINVAL;
 
-	mbus_fmt->width = mode->width;
-	mbus_fmt->height = mode->height;
-	mbus_fmt->code = MEDIA_BUS_FMT_SGRBG10_1X10;
-	mbus_fmt->field = V4L2_FIELD_NONE;
-	mbus_fmt->colorspace = V4L2_COLORSPACE_RAW;
+	if (!fi->interval.numerator || !fi->interval.denominator) {
+		vts = mode->vts;
+	} else {
+		vts = div64_u64((u64)mode->pixel_rate * fi->interval.numerator +
+				(u64)mode->hts * fi->interval.denominator / 2,
+				(u64)mode->hts * fi->interval.denominator);
+		vts = clamp_t(u64, vts, gc2607_vts_min(mode), GC2607_VTS_MAX);
+	}
 
-	/* Only support ACTIVE format (TRY not implemented) */
-	if (format->which == V4L2_SUBDEV_FORMAT_ACTIVE) {
-		gc2607->cur_mode = mode;
-		gc2607->fmt = *mbus_fmt;
+	if (fi->which == V4L2_SUBDEV_FORMAT_ACTIVE) {
+		ret = __v4l2_ctrl_s_ctrl(gc2607->vblank, vts - crop->height);
+		if (ret)
+			return ret;
 	}
 
+	gc2607_vts_to_interval(mode, vts, &fi->interval);
+	*v4l2_subdev_state_get_interval(sd_state, 0) = fi->interval;
 	return 0;
 }
 
 static const struct v4l2_subdev_pad_ops gc2607_pad_ops = {
 	.enum_mbus_code = gc2607_enum_mbus_code,
 	.enum_frame_size = gc2607_enum_frame_size,
-	.get_fmt = gc2607_get_fmt,
+	.get_fmt = v4l2_subdev_get_fmt,
 	.set_fmt = gc2607_set_fmt,
+	.get_selection = gc2607_get_selection,
+	.set_selection = gc2607_set_selection,
+	.get_frame_interval = gc2607_get_frame_interval,
+	.set_frame_interval = gc2607_set_frame_interval,
 };
 
 /*
  * V4L2 subdev video operations
  */
-static int gc2607_s_stream(struct v4l2_subdev *sd, int enable)
+
+/*
+ * Program the sensor and enable its output. If the sensor has stayed
+ * powered since it was last programmed, its registers (including controls,
+ * which s_ctrl writes while powered) are still valid and only the MIPI
+ * output needs to be re-enabled.
+ */
+static int gc2607_start(struct gc2607 *gc2607)
 {
-	struct gc2607 *gc2607 = to_gc2607(sd);
-	struct i2c_client *client = gc2607->client;
+	struct device *dev = &gc2607->client->dev;
+	bool init = !gc2607->regs_valid;
 	int ret;
 
-	if (enable) {
-		ret = pm_runtime_resume_and_get(&client->dev);
-		if (ret)
-			return ret;
-
-		dev_info(&client->dev, "Initializing sensor registers...\n");
+	if (init) {
+		dev_info(dev, "Initializing sensor registers...\n");
 
-		/* Write initialization sequence for current mode */
-		ret = gc2607_write_array(gc2607, gc2607->cur_mode->reg_list);
+		/* The init table, with the current mode's window */
+		ret = gc2607_sync_regs(gc2607);
 		if (ret) {
-			dev_err(&client->dev, "Failed to initialize sensor: %d\n", ret);
-			pm_runtime_put(&client->dev);
+			dev_err(dev, "Failed to initialize sensor: %d\n", ret);
 			return ret;
 		}
 
 		/* Apply current control values (exposure, gain) */
 		ret = __v4l2_ctrl_handler_setup(&gc2607->ctrls);
 		if (ret) {
-			dev_err(&client->dev, "Failed to apply controls: %d\n", ret);
-			pm_runtime_put(&client->dev);
+			dev_err(dev, "Failed to apply controls: %d\n", ret);
+			return ret;
+		}
+
+		gc2607->regs_valid = true;
+	}
+
+	/* Enable MIPI output last, once everything is configured */
+	ret = gc2607_write_array(gc2607, gc2607_stream_on_regs);
+	if (ret) {
+		dev_err(dev, "Failed to start streaming: %d\n", ret);
+		gc2607->regs_valid = false;
+		return ret;
+	}
+
+	/* The reference writes the rest of its table with MIPI running */
+	if (init) {
+		ret = gc2607_write_segs(gc2607, gc2607_init_post_segs);
+		if (ret) {
+			dev_err(dev, "Failed to write post-stream registers: %d\n",
+				ret);
+			gc2607->regs_valid = false;
 			return ret;
 		}
+	}
+
+	return 0;
+}
+
+static int gc2607_s_stream(struct v4l2_subdev *sd, int enable)
+{
+	struct gc2607 *gc2607 = to_gc2607(sd);
+	struct i2c_client *client = gc2607->client;
+	struct v4l2_subdev_state *state;
+	u32 xfers = gc2607->xfer_count;
+	u32 bytes = gc2607->xfer_bytes;
+	ktime_t start = ktime_get();
+	bool restart;
+	int ret, err;
+	s64 us;
+
+	/* Also takes the control lock, for __v4l2_ctrl_handler_setup() */
+	state = v4l2_subdev_lock_and_get_active_state(sd);
+
+	if (enable) {
+		ret = pm_runtime_resume_and_get(&client->dev);
+		if (ret)
+			goto out;
+
+		restart = gc2607->regs_valid;
+		ret = gc2607_start(gc2607);
+		if (ret) {
+			/*
+			 * The retries did not get through. Power-cycle and
+			 * program the sensor from the cache once, which costs
+			 * milliseconds; a driver reload costs seconds.
+			 */
+			err = ret;
+			dev_warn(&client->dev, "Stream start failed (%d), power-cycling sensor\n",
+				 err);
+			atomic64_inc(&gc2607->stats.recoveries);
+			ret = gc2607_power_cycle(gc2607);
+			if (!ret)
+				ret = gc2607_start(gc2607);
+			trace_gc2607_recover(&client->dev, err, ret);
+			if (ret) {
+				atomic64_inc(&gc2607->stats.recovery_failures);
+				dev_err(&client->dev, "Recovery failed: %d\n", ret);
+				goto err_put;
+			}
+			restart = false;
+		}
 
-		dev_info(&client->dev, "Stream ON - sensor initialized\n");
+		/* The Bayer order must not change under a running pipeline */
+		__v4l2_ctrl_grab(gc2607->hflip, true);
+		__v4l2_ctrl_grab(gc2607->vflip, true);
+
+		us = ktime_us_delta(ktime_get(), start);
+		trace_gc2607_stream_on(&client->dev, restart,
+				       gc2607->xfer_count - xfers,
+				       gc2607->xfer_bytes - bytes, us);
+		gc2607_stat_add(restart ? &gc2607->stats.stream_restart :
+					  &gc2607->stats.stream_init, us, 0);
+		dev_info(&client->dev, "Stream ON - %s in %lld us (%u I2C transfers)\n",
+			 restart ? "fast restart" : "sensor initialized", us,
+			 gc2607->xfer_count - xfers);
 		gc2607->streaming = true;
 	} else {
+		/* Stop MIPI output but keep the programmed state for a restart */
+		ret = gc2607_write_array(gc2607, gc2607_stream_off_regs);
+		if (ret) {
+			dev_warn(&client->dev, "Failed to stop streaming: %d\n", ret);
+			gc2607->regs_valid = false;
+		}
+
+		trace_gc2607_stream_off(&client->dev, ret);
 		dev_info(&client->dev, "Stream OFF\n");
 		gc2607->streaming = false;
-		pm_runtime_put(&client->dev);
+		__v4l2_ctrl_grab(gc2607->hflip, false);
+		__v4l2_ctrl_grab(gc2607->vflip, false);
+
+		/* Stay powered for a while in case streaming restarts soon */
+		pm_runtime_mark_last_busy(&client->dev);
+		pm_runtime_put_autosuspend(&client->dev);
 	}
 
+	v4l2_subdev_unlock_state(state);
 	return 0;
+
+err_put:
+	pm_runtime_mark_last_busy(&client->dev);
+	pm_runtime_put_autosuspend(&client->dev);
+out:
+	v4l2_subdev_unlock_state(state);
+	return ret;
 }
 
 /*
  * V4L2 control operations
  */
+
+/*
+ * Write exposure and the four gain LUT registers as one i2c_transfer() of
+ * three bursts, like the reference gc2607_set_expo(). The sensor latches
+ * exposure and gain at the next frame start; as it has no documented
+ * group-hold register, keeping the update to a single bus transaction is
+ * what stops a frame from seeing the new exposure with the old gain.
+ *
+ * @gain is linear in 1/64 units. The largest LUT entry not above it sets
+ * the analogue stages, and its 0x020c/0x020d value is scaled by the
+ * remainder, at most the ~20% to the next entry. Requests that fall on
+ * an entry write exactly the reference registers. @dgain, in the same
+ * units, scales that value again and costs no extra register.
+ */
+static int gc2607_set_exposure_gain(struct gc2607 *gc2607, u32 exposure,
+				    u32 gain, u32 dgain_ctrl)
+{
+	const struct gc2607_gain_lut *lut = &gc2607_gain_table[0];
+	struct gc2607_regval regs[] = {
+		{GC2607_REG_EXPOSURE_H, (exposure >> 8) & 0xff},
+		{GC2607_REG_EXPOSURE_L, exposure & 0xff},
+		{GC2607_REG_AGAIN_H, 0x00},
+		{GC2607_REG_AGAIN_L, 0x00},
+		{GC2607_REG_DGAIN_H, 0x00},
+		{GC2607_REG_DGAIN_L, 0x00},
+		{GC2607_REG_END, 0x00},
+	};
+	unsigned int i;
+	u32 dgain;
+
+	for (i = 1; i < GC2607_GAIN_TABLE_SIZE; i++) {
+		if (gc2607_gain_table[i].gain > gain)
+			break;
+		lut = &gc2607_gain_table[i];
+	}
+
+	dgain = DIV_ROUND_CLOSEST(((lut->reg20c << 8) | lut->reg20d) * gain,
+				  lut->gain);
+	dgain = min_t(u32, DIV_ROUND_CLOSEST(dgain * dgain_ctrl,
+					     GC2607_DGAIN_MIN),
+		      GC2607_DGAIN_REG_MAX);
+
+	regs[2].val = lut->reg2b3;
+	regs[3].val = lut->reg2b4;
+	regs[4].val = (dgain >> 8) & 0xff;
+	regs[5].val = dgain & 0xff;
+
+	return gc2607_write_array(gc2607, regs);
+}
+
+/* Frame length in lines; the reference gc2607_set_fps() writes the same pair */
+static int gc2607_set_vts(struct gc2607 *gc2607, u32 vts)
+{
+	const struct gc2607_regval regs[] = {
+		{GC2607_REG_VTS_H, (vts >> 8) & 0xff},
+		{GC2607_REG_VTS_L, vts & 0xff},
+		{GC2607_REG_END, 0x00},
+	};
+
+	return gc2607_write_array(gc2607, regs);
+}
+
+static int gc2607_set_flip(struct gc2607 *gc2607, bool hflip, bool vflip)
+{
+	return gc2607_write_reg(gc2607, GC2607_REG_FLIP,
+				(hflip ? GC2607_FLIP_H : 0) |
+				(vflip ? GC2607_FLIP_V : 0));
+}
+
 static int gc2607_s_ctrl(struct v4l2_ctrl *ctrl)
 {
 	struct gc2607 *gc2607 = container_of(ctrl->handler,
 					     struct gc2607, ctrls);
 	struct i2c_client *client = gc2607->client;
+	u32 height = gc2607_active_crop(gc2607)->height;
+	ktime_t start;
+	unsigned int i;
 	int ret = 0;
+	s64 us;
 
-	/* Only apply controls when streaming */
-	if (!pm_runtime_get_if_in_use(&client->dev))
+	/* Exposure must stay below the frame length; follow VBLANK changes */
+	if (ctrl->id == V4L2_CID_VBLANK) {
+		ret = gc2607_update_exposure_range(gc2607, height, ctrl->val);
+		if (ret)
+			return ret;
+	}
+
+	/* The flips are grabbed while streaming, so the format can follow */
+	if (ctrl->id == V4L2_CID_HFLIP) {
+		struct v4l2_subdev_state *state;
+
+		state = v4l2_subdev_get_locked_active_state(&gc2607->sd);
+		v4l2_subdev_state_get_format(state, 0)->code =
+			gc2607_bayer_code(gc2607);
+	}
+
+	/*
+	 * Apply controls whenever the sensor is powered, so a fast stream
+	 * restart sees them. Otherwise they are replayed at the next full
+	 * initialization.
+	 */
+	if (pm_runtime_get_if_active(&client->dev) <= 0)
 		return 0;
 
+	start = ktime_get();
 	switch (ctrl->id) {
 	case V4L2_CID_EXPOSURE:
-		/* Write exposure value to registers (16-bit) */
-		ret = gc2607_write_reg(gc2607, GC2607_REG_EXPOSURE_H,
-				       (ctrl->val >> 8) & 0xff);
-		if (ret)
-			break;
-		ret = gc2607_write_reg(gc2607, GC2607_REG_EXPOSURE_L,
-				       ctrl->val & 0xff);
+		/*
+		 * Exposure and gain are clustered, so this is called once for
+		 * both and they reach the sensor in the same transfer.
+		 */
+		ret = gc2607_set_exposure_gain(gc2607, gc2607->exposure->val,
+					       gc2607->gain->val,
+					       gc2607->digital_gain->val);
 		if (!ret)
-			dev_dbg(&client->dev, "Set exposure to %d\n", ctrl->val);
+			dev_dbg(&client->dev,
+				"Set exposure %d, gain %d/64, digital gain %d/64\n",
+				gc2607->exposure->val, gc2607->gain->val,
+				gc2607->digital_gain->val);
 		break;
 
-	case V4L2_CID_ANALOGUE_GAIN:
-		/* Always use the calibrated LUT for optimal noise performance.
-		 * ctrl->val is LUT index (0-16), not raw register value.
-		 */
-		if (ctrl->val < 0 || ctrl->val >= GC2607_GAIN_TABLE_SIZE) {
-			dev_err(&client->dev, "Invalid gain LUT index %d\n", ctrl->val);
-			ret = -EINVAL;
-			break;
-		}
-
-		/* Get calibrated register values from LUT */
-		{
-			const struct gc2607_gain_lut *lut = &gc2607_gain_table[ctrl->val];
-
-			/* Write all 4 gain registers for proper calibration */
-			ret = gc2607_write_reg(gc2607, GC2607_REG_AGAIN_H, lut->reg2b3);
-			if (!ret) ret = gc2607_write_reg(gc2607, GC2607_REG_AGAIN_L, lut->reg2b4);
-			if (!ret) ret = gc2607_write_reg(gc2607, GC2607_REG_DGAIN_H, lut->reg20c);
-			if (!ret) ret = gc2607_write_reg(gc2607, GC2607_REG_DGAIN_L, lut->reg20d);
+	case V4L2_CID_VBLANK:
+		ret = gc2607_set_vts(gc2607, height + ctrl->val);
+		if (!ret)
+			dev_dbg(&client->dev, "Set VTS to %u\n",
+				height + ctrl->val);
+		break;
 
-			if (!ret)
-				dev_dbg(&client->dev, "Set gain to LUT index %d\n", ctrl->val);
-		}
+	case V4L2_CID_HFLIP:
+		/* Clustered with VFLIP: both bits in one write */
+		ret = gc2607_set_flip(gc2607, gc2607->hflip->val,
+				      gc2607->vflip->val);
+		if (!ret)
+			dev_dbg(&client->dev, "Set hflip %d, vflip %d\n",
+				gc2607->hflip->val, gc2607->vflip->val);
 		break;
 
 	default:
@@ -667,7 +1751,18 @@ static int gc2607_s_ctrl(struct v4l2_ctrl *ctrl)
 		break;
 	}
 
-	pm_runtime_put(&client->dev);
+	/* Register state unknown after a failed write; reprogram at STREAMON */
+	if (ret)
+		gc2607->regs_valid = false;
+
+	us = ktime_us_delta(ktime_get(), start);
+	trace_gc2607_ctrl(&client->dev, ctrl, us, ret);
+	for (i = 0; i < ARRAY_SIZE(gc2607_stats_ctrls); i++)
+		if (gc2607_stats_ctrls[i] == ctrl->id)
+			gc2607_stat_add(&gc2607->stats.ctrl[i], us, ret);
+
+	pm_runtime_mark_last_busy(&client->dev);
+	pm_runtime_put_autosuspend(&client->dev);
 	return ret;
 }
 
@@ -684,6 +1779,10 @@ static const struct v4l2_subdev_ops gc2607_subdev_ops = {
 	.pad = &gc2607_pad_ops,
 };
 
+static const struct v4l2_subdev_internal_ops gc2607_internal_ops = {
+	.init_state = gc2607_init_state,
+};
+
 /*
  * Detect chip ID to verify sensor presence
  */
@@ -735,6 +1834,10 @@ static int gc2607_runtime_suspend(struct device *dev)
 	struct v4l2_subdev *sd = i2c_get_clientdata(client);
 	struct gc2607 *gc2607 = to_gc2607(sd);
 
+	/* Registers are lost with power; keep later writes in the cache */
+	gc2607->regs_valid = false;
+	regcache_cache_only(gc2607->regmap, true);
+
 	gc2607_power_off(gc2607);
 	return 0;
 }
@@ -744,20 +1847,121 @@ static int gc2607_runtime_resume(struct device *dev)
 	struct i2c_client *client = to_i2c_client(dev);
 	struct v4l2_subdev *sd = i2c_get_clientdata(client);
 	struct gc2607 *gc2607 = to_gc2607(sd);
+	int ret;
 
-	return gc2607_power_on(gc2607);
+	ret = gc2607_power_on(gc2607);
+	if (ret)
+		return ret;
+
+	regcache_cache_only(gc2607->regmap, false);
+	return 0;
 }
 
 static const struct dev_pm_ops gc2607_pm_ops = {
 	SET_RUNTIME_PM_OPS(gc2607_runtime_suspend, gc2607_runtime_resume, NULL)
 };
 
+/*
+ * debugfs, in the I2C core's per-client directory
+ * (/sys/kernel/debug/i2c/i2c-N/N-0037/)
+ */
+static void gc2607_stats_show_stat(struct seq_file *m, const char *name,
+				   const struct gc2607_stat *st)
+{
+	s64 count = atomic64_read(&st->count);
+
+	seq_printf(m, "%-24s count %lld, errors %lld, avg %lld us, max %lld us\n",
+		   name, count, atomic64_read(&st->errors),
+		   count ? div64_s64(atomic64_read(&st->total_us), count) : 0,
+		   atomic64_read(&st->max_us));
+}
+
+static int gc2607_stats_show(struct seq_file *m, void *data)
+{
+	struct gc2607 *gc2607 = m->private;
+	struct gc2607_stats *st = &gc2607->stats;
+	unsigned int i;
+
+	seq_printf(m, "i2c_transfers %lld\n", atomic64_read(&st->i2c_xfers));
+	seq_printf(m, "i2c_bytes %lld\n", atomic64_read(&st->i2c_bytes));
+	seq_printf(m, "i2c_retries %lld\n", atomic64_read(&st->i2c_retries));
+	seq_printf(m, "i2c_errors %lld\n", atomic64_read(&st->i2c_errors));
+	seq_printf(m, "recoveries %lld\n", atomic64_read(&st->recoveries));
+	seq_printf(m, "recovery_failures %lld\n",
+		   atomic64_read(&st->recovery_failures));
+
+	seq_puts(m, "i2c_latency_us\n");
+	for (i = 0; i < GC2607_STATS_HIST_BUCKETS; i++) {
+		u64 lo = i ? 1ULL << (i - 1) : 0;
+
+		if (i == GC2607_STATS_HIST_BUCKETS - 1)
+			seq_printf(m, "  %6llu+       %lld\n", lo,
+				   atomic64_read(&st->i2c_hist[i]));
+		else
+			seq_printf(m, "  %6llu-%-6llu %lld\n", lo, (1ULL << i) - 1,
+				   atomic64_read(&st->i2c_hist[i]));
+	}
+
+	gc2607_stats_show_stat(m, "power_on", &st->power_on);
+	gc2607_stats_show_stat(m, "power_off", &st->power_off);
+	gc2607_stats_show_stat(m, "stream_on_init", &st->stream_init);
+	gc2607_stats_show_stat(m, "stream_on_restart", &st->stream_restart);
+	for (i = 0; i < ARRAY_SIZE(gc2607_stats_ctrls); i++)
+		gc2607_stats_show_stat(m,
+				       v4l2_ctrl_get_name(gc2607_stats_ctrls[i]),
+				       &st->ctrl[i]);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(gc2607_stats);
+
+/* Any write clears the statistics */
+static int gc2607_stats_reset(void *data, u64 val)
+{
+	struct gc2607 *gc2607 = data;
+	atomic64_t *v = (atomic64_t *)&gc2607->stats;
+	unsigned int i;
+
+	for (i = 0; i < sizeof(gc2607->stats) / sizeof(*v); i++)
+		atomic64_set(&v[i], 0);
+
+	return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(gc2607_stats_reset_fops, NULL, gc2607_stats_reset,
+			 "%llu\n");
+
+static void gc2607_debugfs_init(struct gc2607 *gc2607)
+{
+	struct dentry *dir = gc2607->client->debugfs;
+
+	debugfs_create_u64("power_on_us", 0444, dir, &gc2607->power_on_us);
+	debugfs_create_u32("t_supply_us", 0644, dir, &gc2607->timing.supply_us);
+	debugfs_create_u32("t_clk_to_reset_us", 0644, dir,
+			   &gc2607->timing.clk_to_reset_us);
+	debugfs_create_u32("t_pre_reset_us", 0644, dir,
+			   &gc2607->timing.pre_reset_us);
+	debugfs_create_u32("t_reset_us", 0644, dir, &gc2607->timing.reset_us);
+	debugfs_create_u32("t_post_reset_us", 0644, dir,
+			   &gc2607->timing.post_reset_us);
+	debugfs_create_u32("t_powerdown_us", 0644, dir,
+			   &gc2607->timing.powerdown_us);
+	debugfs_create_u32("t_boot_us", 0644, dir, &gc2607->timing.boot_us);
+
+	debugfs_create_file("stats", 0444, dir, gc2607, &gc2607_stats_fops);
+	debugfs_create_file_unsafe("stats_reset", 0200, dir, gc2607,
+				   &gc2607_stats_reset_fops);
+
+	/* Fail the next N I2C transfer attempts, to test retry and recovery */
+	debugfs_create_atomic_t("fail_xfers", 0600, dir, &gc2607->fail_xfers);
+}
+
 /*
  * I2C driver probe/remove
  */
 static int gc2607_probe(struct i2c_client *client)
 {
 	struct device *dev = &client->dev;
+	struct v4l2_fwnode_device_properties props;
 	struct gc2607 *gc2607;
 	int ret;
 
@@ -769,6 +1973,14 @@ static int gc2607_probe(struct i2c_client *client)
 
 	gc2607->client = client;
 
+	gc2607->regmap = devm_regmap_init(dev, &gc2607_regmap_bus, gc2607,
+					  &gc2607_regmap_config);
+	if (IS_ERR(gc2607->regmap)) {
+		ret = PTR_ERR(gc2607->regmap);
+		dev_err(dev, "Failed to init regmap: %d\n", ret);
+		return ret;
+	}
+
 	/* Initialize regulator supply names */
 	gc2607->supplies[0].supply = "avdd";  /* Analog power */
 	gc2607->supplies[1].supply = "dovdd"; /* I/O power */
@@ -787,7 +1999,7 @@ static int gc2607_probe(struct i2c_client *client)
 	}
 
 	/* Get reset GPIO (optional on some platforms) */
-	gc2607->reset_gpio = devm_gpiod_get_optional(dev, "reset", GPIOD_OUT_LOW);
+	gc2607->reset_gpio = devm_gpiod_get_optional(dev, "reset", GPIOD_OUT_HIGH);
 	if (IS_ERR(gc2607->reset_gpio)) {
 		ret = PTR_ERR(gc2607->reset_gpio);
 		dev_err(dev, "Failed to get reset GPIO: %d\n", ret);
@@ -801,7 +2013,7 @@ static int gc2607_probe(struct i2c_client *client)
 
 	/* Get powerdown GPIO (optional - active high: 1=powerdown, 0=running) */
 	gc2607->powerdown_gpio = devm_gpiod_get_optional(dev, "powerdown",
-							  GPIOD_OUT_LOW);
+							  GPIOD_OUT_HIGH);
 	if (IS_ERR(gc2607->powerdown_gpio)) {
 		ret = PTR_ERR(gc2607->powerdown_gpio);
 		dev_err(dev, "Failed to get powerdown GPIO: %d\n", ret);
@@ -828,10 +2040,21 @@ static int gc2607_probe(struct i2c_client *client)
 		dev_warn(dev, "No clock from platform, assuming INT3472 provides it\n");
 	}
 
+	gc2607_get_power_timing(gc2607);
+	gc2607_debugfs_init(gc2607);
+
 	dev_info(dev, "Resources acquired successfully\n");
 
+	/* Mounting rotation and orientation, from ACPI/fwnode */
+	ret = v4l2_fwnode_device_parse(dev, &props);
+	if (ret) {
+		dev_err(dev, "Failed to parse fwnode properties: %d\n", ret);
+		return ret;
+	}
+
 	/* Initialize V4L2 subdev */
 	v4l2_i2c_subdev_init(&gc2607->sd, client, &gc2607_subdev_ops);
+	gc2607->sd.internal_ops = &gc2607_internal_ops;
 	gc2607->sd.flags |= V4L2_SUBDEV_FL_HAS_DEVNODE;
 
 	/* Initialize media pad */
@@ -844,7 +2067,7 @@ static int gc2607_probe(struct i2c_client *client)
 	}
 
 	/* Initialize control handler with V4L2 controls */
-	v4l2_ctrl_handler_init(&gc2607->ctrls, 4);
+	v4l2_ctrl_handler_init(&gc2607->ctrls, 11);
 
 	/* Link frequency control (required by IPU6) */
 	gc2607->link_freq = v4l2_ctrl_new_int_menu(&gc2607->ctrls,
@@ -860,10 +2083,10 @@ static int gc2607_probe(struct i2c_client *client)
 	gc2607->pixel_rate = v4l2_ctrl_new_std(&gc2607->ctrls,
 						NULL,
 						V4L2_CID_PIXEL_RATE,
-						GC2607_PIXEL_RATE,
-						GC2607_PIXEL_RATE,
+						gc2607_modes[0].pixel_rate,
+						gc2607_modes[0].pixel_rate,
 						1,
-						GC2607_PIXEL_RATE);
+						gc2607_modes[0].pixel_rate);
 	if (gc2607->pixel_rate)
 		gc2607->pixel_rate->flags |= V4L2_CTRL_FLAG_READ_ONLY;
 
@@ -885,32 +2108,83 @@ static int gc2607_probe(struct i2c_client *client)
 					  GC2607_GAIN_STEP,
 					  GC2607_GAIN_DEFAULT);
 
+	/* Digital gain, applied on top of the analogue LUT */
+	gc2607->digital_gain = v4l2_ctrl_new_std(&gc2607->ctrls,
+						  &gc2607_ctrl_ops,
+						  V4L2_CID_DIGITAL_GAIN,
+						  GC2607_DGAIN_MIN,
+						  GC2607_DGAIN_MAX,
+						  GC2607_DGAIN_STEP,
+						  GC2607_DGAIN_DEFAULT);
+
+	/* Vertical blanking sets the frame length, and with it the frame rate */
+	gc2607->vblank = v4l2_ctrl_new_std(&gc2607->ctrls,
+					    &gc2607_ctrl_ops,
+					    V4L2_CID_VBLANK,
+					    gc2607_vts_min(&gc2607_modes[0]) -
+					    gc2607_modes[0].height,
+					    GC2607_VTS_MAX - gc2607_modes[0].height,
+					    1,
+					    gc2607_modes[0].vts - gc2607_modes[0].height);
+
+	/* Horizontal blanking is fixed by the mode */
+	gc2607->hblank = v4l2_ctrl_new_std(&gc2607->ctrls,
+					    NULL,
+					    V4L2_CID_HBLANK,
+					    gc2607_modes[0].hts - gc2607_modes[0].width,
+					    gc2607_modes[0].hts - gc2607_modes[0].width,
+					    1,
+					    gc2607_modes[0].hts - gc2607_modes[0].width);
+	if (gc2607->hblank)
+		gc2607->hblank->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+	/*
+	 * The flips start off, so the default readout is the image that
+	 * V4L2_CID_CAMERA_SENSOR_ROTATION describes. Userspace that honours
+	 * the rotation, e.g. libcamera, turns both flips on itself to undo a
+	 * 180 degree mounting; flipping by default as well would rotate twice.
+	 */
+	gc2607->hflip = v4l2_ctrl_new_std(&gc2607->ctrls, &gc2607_ctrl_ops,
+					   V4L2_CID_HFLIP, 0, 1, 1, 0);
+	gc2607->vflip = v4l2_ctrl_new_std(&gc2607->ctrls, &gc2607_ctrl_ops,
+					   V4L2_CID_VFLIP, 0, 1, 1, 0);
+	if (gc2607->hflip)
+		gc2607->hflip->flags |= V4L2_CTRL_FLAG_MODIFY_LAYOUT;
+	if (gc2607->vflip)
+		gc2607->vflip->flags |= V4L2_CTRL_FLAG_MODIFY_LAYOUT;
+
+	/* Read-only V4L2_CID_ORIENTATION and V4L2_CID_CAMERA_SENSOR_ROTATION */
+	v4l2_ctrl_new_fwnode_properties(&gc2607->ctrls, &gc2607_ctrl_ops,
+					&props);
+
+	/* Exposure and both gains are always written together */
+	v4l2_ctrl_cluster(3, &gc2607->exposure);
+	v4l2_ctrl_cluster(2, &gc2607->hflip);
+
 	gc2607->sd.ctrl_handler = &gc2607->ctrls;
 
 	if (gc2607->ctrls.error) {
 		ret = gc2607->ctrls.error;
 		dev_err(dev, "Control handler init failed: %d\n", ret);
-		goto err_media;
+		goto err_ctrls;
 	}
 
-	/* Initialize current mode and format */
-	gc2607->cur_mode = &gc2607_modes[0];
-	gc2607->fmt.width = gc2607->cur_mode->width;
-	gc2607->fmt.height = gc2607->cur_mode->height;
-	gc2607->fmt.code = MEDIA_BUS_FMT_SGRBG10_1X10;
-	gc2607->fmt.field = V4L2_FIELD_NONE;
-	gc2607->fmt.colorspace = V4L2_COLORSPACE_RAW;
-
-	/* Enable runtime PM */
-	pm_runtime_set_active(dev);
-	pm_runtime_enable(dev);
-	pm_runtime_idle(dev);
+	/*
+	 * Formats, crops and frame intervals live in the subdev state, locked
+	 * together with the controls so s_ctrl sees a consistent crop.
+	 */
+	gc2607->sd.state_lock = gc2607->ctrls.lock;
+	ret = v4l2_subdev_init_finalize(&gc2607->sd);
+	if (ret) {
+		dev_err(dev, "Subdev init failed: %d\n", ret);
+		goto err_ctrls;
+	}
 
 	/* Power on sensor and detect chip ID */
-	ret = pm_runtime_resume_and_get(dev);
+	ret = gc2607_power_on(gc2607);
 	if (ret) {
 		dev_err(dev, "Failed to power on sensor: %d\n", ret);
-		goto err_pm;
+		goto err_subdev;
 	}
 
 	ret = gc2607_detect(gc2607);
@@ -919,32 +2193,56 @@ static int gc2607_probe(struct i2c_client *client)
 		goto err_power;
 	}
 
-	/* Power off after detection */
-	pm_runtime_put(dev);
+	/* The default mode's window, for the first stream start */
+	ret = gc2607_cache_window(gc2607, &gc2607_modes[0].crop);
+	if (ret)
+		goto err_power;
+
+	/*
+	 * The sensor is powered, so runtime PM starts out active, holding a
+	 * reference until the subdev is registered. Autosuspend keeps it
+	 * powered for a while after each use, so that closing and reopening
+	 * the camera within the delay skips the power-up sequence, ~100 ms
+	 * with the default timing. The delay can be tuned at runtime through
+	 * power/autosuspend_delay_ms in sysfs.
+	 */
+	pm_runtime_set_active(dev);
+	pm_runtime_get_noresume(dev);
+	pm_runtime_enable(dev);
+	pm_runtime_set_autosuspend_delay(dev, autosuspend_delay_ms);
+	pm_runtime_use_autosuspend(dev);
 
 	/* Register async subdev for IPU6 integration */
 	ret = v4l2_async_register_subdev(&gc2607->sd);
 	if (ret) {
 		dev_err(dev, "Failed to register async subdev: %d\n", ret);
-		goto err_power;
+		goto err_pm;
 	}
 
+	/* Power off after detection, once the autosuspend delay expires */
+	pm_runtime_mark_last_busy(dev);
+	pm_runtime_put_autosuspend(dev);
+
 	dev_info(dev, "GC2607 probe successful\n");
 	dev_info(dev, "  I2C address: 0x%02x\n", client->addr);
 	dev_info(dev, "  I2C adapter: %s\n", client->adapter->name);
 	dev_info(dev, "  Format: SGRBG10 %ux%u@%ufps\n",
-		 gc2607->cur_mode->width, gc2607->cur_mode->height,
-		 gc2607->cur_mode->max_fps);
+		 gc2607_modes[0].width, gc2607_modes[0].height,
+		 gc2607_modes[0].max_fps);
 
 	return 0;
 
-err_power:
-	pm_runtime_put_noidle(dev);
 err_pm:
 	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
 	pm_runtime_set_suspended(dev);
+	pm_runtime_put_noidle(dev);
+err_power:
+	gc2607_power_off(gc2607);
+err_subdev:
+	v4l2_subdev_cleanup(&gc2607->sd);
+err_ctrls:
 	v4l2_ctrl_handler_free(&gc2607->ctrls);
-err_media:
 	media_entity_cleanup(&gc2607->sd.entity);
 	return ret;
 }
@@ -958,11 +2256,13 @@ static void gc2607_remove(struct i2c_client *client)
 	dev_info(dev, "GC2607 driver removing\n");
 
 	v4l2_async_unregister_subdev(sd);
+	v4l2_subdev_cleanup(sd);
 	media_entity_cleanup(&sd->entity);
 	v4l2_ctrl_handler_free(&gc2607->ctrls);
 
 	/* Disable runtime PM */
 	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
 	if (!pm_runtime_status_suspended(dev))
 		gc2607_power_off(gc2607);
 	pm_runtime_set_suspended(dev);
@@ -1004,3 +2304,7 @@ module_i2c_driver(gc2607_i2c_driver);
 MODULE_DESCRIPTION("GalaxyCore GC2607 sensor driver");
 MODULE_AUTHOR("Your Name <your.email@example.com>");
 MODULE_LICENSE("GPL");
+
+#ifdef GC2607_KUNIT
+#include "tests/gc2607_kunit.c"
+#endif
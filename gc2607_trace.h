@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * GC2607 tracepoints
+ *
+ * Timings of the steps between opening the camera and the first frame:
+ * power sequencing, register programming, control writes and stream
+ * start/stop. Durations are in microseconds, I2C byte counts include the
+ * 16-bit register address of every message.
+ *
+ *   trace-cmd record -e gc2607 -- v4l2-ctl --stream-mmap --stream-count=1
+ *   perf trace -e 'gc2607:*' ...
+ */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM gc2607
+
+#if !defined(_GC2607_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _GC2607_TRACE_H
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+#include <media/v4l2-ctrls.h>
+
+DECLARE_EVENT_CLASS(gc2607_power,
+	TP_PROTO(const struct device *dev, s64 us),
+	TP_ARGS(dev, us),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(s64, us)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->us = us;
+	),
+
+	TP_printk("%s: %lld us", __get_str(dev), __entry->us)
+);
+
+/* Supplies, clock, reset pulse and boot delay */
+DEFINE_EVENT(gc2607_power, gc2607_power_on,
+	TP_PROTO(const struct device *dev, s64 us),
+	TP_ARGS(dev, us)
+);
+
+DEFINE_EVENT(gc2607_power, gc2607_power_off,
+	TP_PROTO(const struct device *dev, s64 us),
+	TP_ARGS(dev, us)
+);
+
+/* An ordered register sequence (soft reset, stream on/off, controls) */
+TRACE_EVENT(gc2607_write_array,
+	TP_PROTO(const struct device *dev, u32 regs, u32 xfers, u32 bytes,
+		 s64 us),
+	TP_ARGS(dev, regs, xfers, bytes, us),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u32, regs)
+		__field(u32, xfers)
+		__field(u32, bytes)
+		__field(s64, us)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->regs = regs;
+		__entry->xfers = xfers;
+		__entry->bytes = bytes;
+		__entry->us = us;
+	),
+
+	TP_printk("%s: %u regs in %u transfers, %u bytes, %lld us",
+		  __get_str(dev), __entry->regs, __entry->xfers,
+		  __entry->bytes, __entry->us)
+);
+
+/* The init table up to the stream enable, soft reset included */
+TRACE_EVENT(gc2607_init_regs,
+	TP_PROTO(const struct device *dev, u32 xfers, u32 bytes, s64 us),
+	TP_ARGS(dev, xfers, bytes, us),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(u32, xfers)
+		__field(u32, bytes)
+		__field(s64, us)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->xfers = xfers;
+		__entry->bytes = bytes;
+		__entry->us = us;
+	),
+
+	TP_printk("%s: %u transfers, %u bytes, %lld us", __get_str(dev),
+		  __entry->xfers, __entry->bytes, __entry->us)
+);
+
+/* A control reaching the sensor; clusters are traced by their first control */
+TRACE_EVENT(gc2607_ctrl,
+	TP_PROTO(const struct device *dev, const struct v4l2_ctrl *ctrl,
+		 s64 us, int ret),
+	TP_ARGS(dev, ctrl, us, ret),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__string(name, ctrl->name)
+		__field(u32, id)
+		__field(s32, val)
+		__field(s64, us)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__assign_str(name);
+		__entry->id = ctrl->id;
+		__entry->val = ctrl->val;
+		__entry->us = us;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: %s (0x%08x) = %d in %lld us, ret %d", __get_str(dev),
+		  __get_str(name), __entry->id, __entry->val, __entry->us,
+		  __entry->ret)
+);
+
+/* Power cycle and reprogram after @err survived the I2C retries */
+TRACE_EVENT(gc2607_recover,
+	TP_PROTO(const struct device *dev, int err, int ret),
+	TP_ARGS(dev, err, ret),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(int, err)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->err = err;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: after error %d, ret %d", __get_str(dev), __entry->err,
+		  __entry->ret)
+);
+
+TRACE_EVENT(gc2607_stream_on,
+	TP_PROTO(const struct device *dev, bool restart, u32 xfers, u32 bytes,
+		 s64 us),
+	TP_ARGS(dev, restart, xfers, bytes, us),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(bool, restart)
+		__field(u32, xfers)
+		__field(u32, bytes)
+		__field(s64, us)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->restart = restart;
+		__entry->xfers = xfers;
+		__entry->bytes = bytes;
+		__entry->us = us;
+	),
+
+	TP_printk("%s: %s, %u transfers, %u bytes, %lld us", __get_str(dev),
+		  __entry->restart ? "fast restart" : "full init",
+		  __entry->xfers, __entry->bytes, __entry->us)
+);
+
+TRACE_EVENT(gc2607_stream_off,
+	TP_PROTO(const struct device *dev, int ret),
+	TP_ARGS(dev, ret),
+
+	TP_STRUCT__entry(
+		__string(dev, dev_name(dev))
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__assign_str(dev);
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: ret %d", __get_str(dev), __entry->ret)
+);
+
+#endif /* _GC2607_TRACE_H */
+
+/* The header is outside include/trace/events; the Makefile adds -I$(src) */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE gc2607_trace
+#include <trace/define_trace.h>
@@ -49,15 +49,40 @@ sleep 2
 echo "Checking driver probe..."
 dmesg | tail -20 | grep -E "gc2607|GC2607" || true
 
+SENSOR=$(media-ctl -d /dev/media0 -p | sed -n 's/.*entity [0-9]*: \(gc2607 [^ ]*\) .*/\1/p' | head -1)
+SUBDEV=$(media-ctl -d /dev/media0 -e "$SENSOR" 2>/dev/null || true)
+
+# The module is mounted upside down. Like libcamera, undo the rotation the
+# sensor reports with its flip controls, so the image comes out the right
+# way up from the sensor; without them gc2607-loopback rotates in software
+ROTATION=$(v4l2-ctl -d "$SUBDEV" --get-ctrl camera_sensor_rotation 2>/dev/null | sed -n 's/.*: *//p')
+if [ "$ROTATION" = "180" ]; then
+    if v4l2-ctl -d "$SUBDEV" --set-ctrl horizontal_flip=1,vertical_flip=1 2>/dev/null; then
+        echo "Sensor rotated 180 degrees, flipping the readout"
+    else
+        echo "Sensor rotated 180 degrees, no flip controls: rotating in software"
+    fi
+fi
+
+# The Bayer order follows the flips, so take it from the sensor pad
+# instead of assuming GRBG
+CODE=$(media-ctl -d /dev/media0 --get-v4l2 "\"$SENSOR\":0" 2>/dev/null | sed -n 's/.*fmt:\([A-Z0-9_]*\)\/.*/\1/p')
+case "$CODE" in
+    SRGGB10_1X10) PIXFMT=RG10 ;;
+    SBGGR10_1X10) PIXFMT=BG10 ;;
+    SGBRG10_1X10) PIXFMT=GB10 ;;
+    *) CODE=SGRBG10_1X10; PIXFMT=BA10 ;;
+esac
+
 # Configure CSI2 formats (this is critical!)
 echo ""
-echo "Configuring CSI2 receiver formats..."
-media-ctl -d /dev/media0 -V '"Intel IPU6 CSI2 0":0 [fmt:SGRBG10_1X10/1920x1080]'
-media-ctl -d /dev/media0 -V '"Intel IPU6 CSI2 0":1 [fmt:SGRBG10_1X10/1920x1080]'
+echo "Configuring CSI2 receiver formats ($CODE)..."
+media-ctl -d /dev/media0 -V "\"Intel IPU6 CSI2 0\":0 [fmt:$CODE/1920x1080]"
+media-ctl -d /dev/media0 -V "\"Intel IPU6 CSI2 0\":1 [fmt:$CODE/1920x1080]"
 
 # Set video device format
 echo "Configuring video device format..."
-v4l2-ctl -d /dev/video0 --set-fmt-video=width=1920,height=1080,pixelformat=BA10
+v4l2-ctl -d /dev/video0 --set-fmt-video=width=1920,height=1080,pixelformat=$PIXFMT
 
 # Enable media link
 echo "Enabling media pipeline..."
@@ -67,7 +92,7 @@ echo ""
 echo "✅ Camera initialized successfully!"
 echo ""
 echo "Default settings:"
-v4l2-ctl -d /dev/v4l-subdev6 --list-ctrls | grep -E "(exposure|gain)"
+v4l2-ctl -d "${SUBDEV:-/dev/v4l-subdev6}" --list-ctrls | grep -E "(exposure|gain|flip)"
 echo ""
 echo "Quick capture test:"
 echo "  v4l2-ctl -d /dev/video0 --stream-mmap --stream-count=1 --stream-to=test.raw"
@@ -0,0 +1,68 @@
+"""Bayer order handling shared by the view_raw*.py scripts
+
+The GC2607 reads out GRBG unflipped. init_camera.sh turns both flip controls
+on when the sensor reports a 180 degree rotation, which gives a GBRG readout
+that is already the right way up. Only an unflipped GRBG capture still needs
+rotating in software, as in gc2607-loopback.
+"""
+
+import re
+import subprocess
+
+BAYER_ORDERS = ('grbg', 'rggb', 'bggr', 'gbrg')
+
+# (row, column) of R, first G, second G and B in each 2x2 quad
+BAYER_OFFSETS = {
+    'grbg': ((0, 1), (0, 0), (1, 1), (1, 0)),
+    'rggb': ((0, 0), (0, 1), (1, 0), (1, 1)),
+    'bggr': ((1, 1), (0, 1), (1, 0), (0, 0)),
+    'gbrg': ((1, 0), (0, 0), (1, 1), (0, 1)),
+}
+
+
+def sensor_bayer(media='/dev/media0'):
+    """Bayer order currently set on the sensor pad, or None"""
+    try:
+        topo = subprocess.run(['media-ctl', '-d', media, '-p'],
+                              capture_output=True, text=True).stdout
+        m = re.search(r'entity \d+: (gc2607 \S+)', topo)
+        if not m:
+            return None
+        fmt = subprocess.run(['media-ctl', '-d', media, '--get-v4l2',
+                              f'"{m.group(1)}":0'],
+                             capture_output=True, text=True).stdout
+    except OSError:
+        return None
+
+    m = re.search(r'fmt:S([A-Z]{4})10_1X10', fmt)
+    if not m or m.group(1).lower() not in BAYER_ORDERS:
+        return None
+    return m.group(1).lower()
+
+
+def bayer_arg(argv):
+    """Remove "--bayer ORDER" from argv and return the order to use
+
+    Without the option the order comes from the sensor, for a capture made
+    just before, and falls back to the unflipped GRBG readout.
+    """
+    if '--bayer' in argv:
+        i = argv.index('--bayer')
+        order = argv[i + 1].lower() if i + 1 < len(argv) else ''
+        del argv[i:i + 2]
+        if order not in BAYER_ORDERS:
+            raise SystemExit(f"--bayer: expected one of {', '.join(BAYER_ORDERS)}")
+        return order
+
+    return sensor_bayer() or 'grbg'
+
+
+def split_channels(img, order):
+    """Return the R, first G, second G and B planes of a Bayer image"""
+    h2, w2 = img.shape[0] // 2, img.shape[1] // 2
+    return [img[y::2, x::2][:h2, :w2] for y, x in BAYER_OFFSETS[order]]
+
+
+def needs_rotation(order):
+    """Only an unflipped readout is still upside down"""
+    return order == 'grbg'
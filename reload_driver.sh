@@ -38,9 +38,18 @@ sleep 2
 
 # Configure format and enable link
 echo "Configuring camera..."
-media-ctl -d /dev/media0 -V '"Intel IPU6 CSI2 0":0 [fmt:SGRBG10_1X10/1920x1080]'
-media-ctl -d /dev/media0 -V '"Intel IPU6 CSI2 0":1 [fmt:SGRBG10_1X10/1920x1080]'
-v4l2-ctl -d /dev/video0 --set-fmt-video=width=1920,height=1080,pixelformat=BA10
+# The Bayer order follows the sensor's flip controls
+SENSOR=$(media-ctl -d /dev/media0 -p | sed -n 's/.*entity [0-9]*: \(gc2607 [^ ]*\) .*/\1/p' | head -1)
+CODE=$(media-ctl -d /dev/media0 --get-v4l2 "\"$SENSOR\":0" 2>/dev/null | sed -n 's/.*fmt:\([A-Z0-9_]*\)\/.*/\1/p')
+case "$CODE" in
+    SRGGB10_1X10) PIXFMT=RG10 ;;
+    SBGGR10_1X10) PIXFMT=BG10 ;;
+    SGBRG10_1X10) PIXFMT=GB10 ;;
+    *) CODE=SGRBG10_1X10; PIXFMT=BA10 ;;
+esac
+media-ctl -d /dev/media0 -V "\"Intel IPU6 CSI2 0\":0 [fmt:$CODE/1920x1080]"
+media-ctl -d /dev/media0 -V "\"Intel IPU6 CSI2 0\":1 [fmt:$CODE/1920x1080]"
+v4l2-ctl -d /dev/video0 --set-fmt-video=width=1920,height=1080,pixelformat=$PIXFMT
 media-ctl -d /dev/media0 -l '"Intel IPU6 CSI2 0":1 -> "Intel IPU6 ISYS Capture 0":0[1]'
 
 echo ""
@@ -49,10 +58,10 @@ echo ""
 echo "Current control settings:"
 v4l2-ctl -d /dev/v4l-subdev6 --list-ctrls
 echo ""
-echo "Note: Gain is now LUT index (0-16), not raw value"
-echo "  Index 0 = 1.0x gain (lowest noise)"
-echo "  Index 2 = 1.45x gain (default)"
-echo "  Index 4 = 2.0x gain"
-echo "  Index 8 = 4.0x gain"
-echo "  Index 16 = 15.8x gain (max)"
+echo "Note: Gain is linear in 1/64 units (64-1012)"
+echo "  64 = 1.0x gain (lowest noise)"
+echo "  93 = 1.45x gain"
+echo "  130 = 2.0x gain"
+echo "  253 = 4.0x gain"
+echo "  1012 = 15.8x gain (max)"
 echo ""
@@ -6,8 +6,9 @@ set -e
 echo "=== Reloading v4l2loopback for Chrome compatibility ==="
 echo ""
 
-# Kill gstreamer if running
-echo "Stopping gstreamer pipeline..."
+# Stop the conversion daemon (or an old gstreamer pipeline) if running
+echo "Stopping conversion pipeline..."
+pkill -f gc2607-loopback 2>/dev/null || true
 pkill -f "gst-launch.*video48" 2>/dev/null || true
 sleep 1
 
@@ -45,20 +46,23 @@ fi
 echo "Virtual camera: $VIRT_DEV"
 echo ""
 
-# Set optimal exposure/gain for good brightness
-# Exposure: 2002 (max), Gain: 16 (max, LUT index)
+# Starting exposure/gain; gc2607-loopback --ae adjusts them per frame
+# Exposure: 2002 (max), Gain: 1012 (max, 15.8x in 1/64 units)
 echo "Setting camera parameters..."
-v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=16
+v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=2002,analogue_gain=1012
+v4l2-ctl -d /dev/v4l-subdev6 --set-subdev-fps pad=0,fps=24
 
 # White balance gains (calculated from gray world)
 R_GAIN=1.034
 G_GAIN=1.000
 B_GAIN=1.246
 
-# Convert to frei0r parameters (0.5 = neutral)
-R_PARAM=$(echo "scale=3; 0.5 * $R_GAIN" | bc)
-G_PARAM=$(echo "scale=3; 0.5 * $G_GAIN" | bc)
-B_PARAM=$(echo "scale=3; 0.5 * $B_GAIN" | bc)
+# Native converter/loopback daemon (built on first use)
+LOOPBACK="$(dirname "$0")/tools/gc2607-loopback"
+if [ ! -x "$LOOPBACK" ]; then
+    echo "Building $LOOPBACK..."
+    make -C "$(dirname "$0")/tools" gc2607-loopback
+fi
 
 echo ""
 echo "Starting conversion pipeline with white balance..."
@@ -66,15 +70,5 @@ echo "WB gains: R=$R_GAIN, G=$G_GAIN, B=$B_GAIN"
 echo "Press Ctrl+C to stop"
 echo ""
 
-# Start pipeline with white balance at 24fps for Chrome
-gst-launch-1.0 -v \
-    v4l2src device=/dev/video0 ! \
-    "video/x-bayer,format=grbg10le,width=1920,height=1080,framerate=24/1" ! \
-    bayer2rgb ! \
-    videoflip method=rotate-180 ! \
-    videoconvert ! \
-    "video/x-raw,format=RGBA" ! \
-    frei0r-filter-coloradj-rgb r=$R_PARAM g=$G_PARAM b=$B_PARAM keep-luma=false ! \
-    videoconvert ! \
-    "video/x-raw,format=I420,framerate=24/1" ! \
-    v4l2sink device=$VIRT_DEV
+# Convert straight to I420 at 24fps for Chrome
+"$LOOPBACK" -f i420 -r 24 -w "$R_GAIN,$G_GAIN,$B_GAIN" --ae /dev/v4l-subdev6 /dev/video0 "$VIRT_DEV"
@@ -0,0 +1,633 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Simulated GC2607 sensor for testing the driver without hardware
+ *
+ * Registers an I2C adapter with a GC2607 register file behind address 0x37
+ * and instantiates a "gc2607" client on it, so the unmodified driver binds
+ * through its I2C id table. The module also acts as a minimal V4L2 bridge:
+ * once the driver registers its subdev, the subdev node is created and the
+ * stream can be toggled through debugfs.
+ *
+ * The model is deliberately small. Registers are plain bytes with 16-bit
+ * addresses; the chip ID reads back 0x2607, a soft reset (0x03fe) restores
+ * the power-on values, and MIPI control (0x0117) starts and stops frames.
+ * While streaming, frames are paced by VTS and rendered as GRBG10 with a
+ * brightness proportional to exposure times the total programmed gain.
+ *
+ * debugfs (/sys/kernel/debug/gc2607-sim):
+ *   stream   - write 1/0 to call the subdev's s_stream, read the state
+ *   frame    - one 16-bit little-endian frame per read, at the frame rate
+ *   status   - decoded sensor state and register traffic counters
+ *   regs     - non-zero registers, "addr value" per line
+ *   reset    - any write clears the traffic counters
+ */
+
+#include <linux/debugfs.h>
+#include <linux/delay.h>
+#include <linux/i2c.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/unaligned.h>
+#include <linux/vmalloc.h>
+#include <media/v4l2-async.h>
+#include <media/v4l2-device.h>
+#include <media/v4l2-subdev.h>
+
+#define SIM_ADDR			0x37
+#define SIM_NUM_REGS			0x1000
+
+#define SIM_REG_CHIP_ID_H		0x03f0
+#define SIM_REG_CHIP_ID_L		0x03f1
+#define SIM_REG_SOFT_RESET		0x03fe
+#define SIM_REG_MIPI_CTRL		0x0117
+#define SIM_REG_FLIP			0x0101
+#define SIM_REG_EXPOSURE_H		0x0202
+#define SIM_REG_EXPOSURE_L		0x0203
+#define SIM_REG_DGAIN_H			0x020c
+#define SIM_REG_DGAIN_L			0x020d
+#define SIM_REG_VTS_H			0x0220
+#define SIM_REG_VTS_L			0x0221
+#define SIM_REG_AGAIN_H			0x02b3
+#define SIM_REG_AGAIN_L			0x02b4
+#define SIM_REG_ROW_COUNT_H		0x034a
+#define SIM_REG_ROW_COUNT_L		0x034b
+#define SIM_REG_COL_COUNT_H		0x034c
+#define SIM_REG_COL_COUNT_L		0x034d
+
+#define SIM_MIPI_ON			0x91
+#define SIM_ROW_MARGIN			8
+#define SIM_HTS				2048
+#define SIM_PIXEL_RATE			(1335LL * 2048 * 30)
+
+#define SIM_MAX_WIDTH			1920
+#define SIM_MAX_HEIGHT			1080
+
+static unsigned int bus_khz = 400;
+module_param(bus_khz, uint, 0644);
+MODULE_PARM_DESC(bus_khz,
+		 "Simulated I2C bus clock in kHz, 0 for no transfer delay (default: 400)");
+
+static unsigned int light = 64;
+module_param(light, uint, 0644);
+MODULE_PARM_DESC(light,
+		 "Scene brightness; 64 puts mid grey at 250 for exposure 2002 and 1x gain (default: 64)");
+
+/*
+ * Analogue gain stages, keyed by the 0x02b3/0x02b4 pair the driver writes.
+ * @dgain is the digital gain register value that yields exactly @gain, so
+ * any other value scales the stage by dgain_reg / @dgain.
+ */
+struct sim_gain_stage {
+	u16 gain;	/* Linear, 1/64 units */
+	u8 reg2b3;
+	u8 reg2b4;
+	u16 dgain;
+};
+
+static const struct sim_gain_stage sim_gain_stages[] = {
+	{  64, 0x00, 0x00, 0x0040},
+	{  76, 0x05, 0x00, 0x004b},
+	{  93, 0x00, 0x01, 0x0059},
+	{ 111, 0x05, 0x01, 0x006a},
+	{ 130, 0x00, 0x02, 0x0080},
+	{ 156, 0x05, 0x02, 0x0097},
+	{ 184, 0x00, 0x03, 0x00b3},
+	{ 221, 0x05, 0x03, 0x00d4},
+	{ 253, 0x00, 0x04, 0x0100},
+	{ 304, 0x05, 0x04, 0x012f},
+	{ 367, 0x00, 0x05, 0x0166},
+	{ 434, 0x05, 0x05, 0x01a8},
+	{ 510, 0x00, 0x06, 0x0200},
+	{ 607, 0x05, 0x06, 0x025e},
+	{ 717, 0x09, 0x26, 0x02cc},
+	{ 847, 0x0c, 0xb6, 0x0350},
+	{1012, 0x10, 0x06, 0x0400},
+};
+
+struct sim_state {
+	u32 width;
+	u32 height;
+	u32 vts;
+	u32 exposure;
+	u32 gain;		/* Total, 1/64 units; 0 for an unknown stage */
+	bool hflip;
+	bool vflip;
+};
+
+struct gc2607_sim {
+	struct i2c_adapter adap;
+	struct i2c_client *client;
+	struct v4l2_device v4l2_dev;
+	struct v4l2_async_notifier notifier;
+	struct v4l2_subdev *sd;
+	struct dentry *debugfs;
+
+	struct mutex lock;	/* Register file, stream state and counters */
+	u8 regs[SIM_NUM_REGS];
+	u16 addr;		/* Register pointer for reads */
+	bool streaming;
+	ktime_t stream_start;
+	u64 frames_read;
+
+	u64 xfers;
+	u64 bytes;
+	u64 reg_writes;
+	u64 reg_reads;
+	u64 resets;
+	u64 stream_starts;
+};
+
+static struct gc2607_sim *sim;
+
+/* Power-on values; everything not listed here reads back as zero */
+static void sim_power_on_reset(struct gc2607_sim *s)
+{
+	memset(s->regs, 0, sizeof(s->regs));
+	s->regs[SIM_REG_CHIP_ID_H] = 0x26;
+	s->regs[SIM_REG_CHIP_ID_L] = 0x07;
+	s->regs[SIM_REG_MIPI_CTRL] = 0x01;
+	s->streaming = false;
+}
+
+static u16 sim_reg16(struct gc2607_sim *s, u16 reg)
+{
+	return (s->regs[reg] << 8) | s->regs[reg + 1];
+}
+
+static void sim_decode(struct gc2607_sim *s, struct sim_state *st)
+{
+	u16 dgain = sim_reg16(s, SIM_REG_DGAIN_H) & 0x0fff;
+	unsigned int i;
+
+	st->width = sim_reg16(s, SIM_REG_COL_COUNT_H);
+	st->height = sim_reg16(s, SIM_REG_ROW_COUNT_H);
+	st->height = st->height > SIM_ROW_MARGIN ?
+		     st->height - SIM_ROW_MARGIN : 0;
+	if (!st->width || st->width > SIM_MAX_WIDTH ||
+	    !st->height || st->height > SIM_MAX_HEIGHT) {
+		st->width = SIM_MAX_WIDTH;
+		st->height = SIM_MAX_HEIGHT;
+	}
+	st->width &= ~1;
+	st->height &= ~1;
+
+	st->vts = max_t(u32, sim_reg16(s, SIM_REG_VTS_H), st->height + 1);
+
+	/* Light is only integrated while the frame lasts */
+	st->exposure = min_t(u32, sim_reg16(s, SIM_REG_EXPOSURE_H),
+			     st->vts - 1);
+
+	st->gain = 0;
+	for (i = 0; i < ARRAY_SIZE(sim_gain_stages); i++) {
+		const struct sim_gain_stage *g = &sim_gain_stages[i];
+
+		if (g->reg2b3 == s->regs[SIM_REG_AGAIN_H] &&
+		    g->reg2b4 == s->regs[SIM_REG_AGAIN_L]) {
+			st->gain = DIV_ROUND_CLOSEST(g->gain * dgain, g->dgain);
+			break;
+		}
+	}
+
+	st->hflip = s->regs[SIM_REG_FLIP] & BIT(0);
+	st->vflip = s->regs[SIM_REG_FLIP] & BIT(1);
+}
+
+static u64 sim_frame_ns(const struct sim_state *st)
+{
+	return div64_u64((u64)st->vts * SIM_HTS * NSEC_PER_SEC, SIM_PIXEL_RATE);
+}
+
+static void sim_write_reg(struct gc2607_sim *s, u16 reg, u8 val)
+{
+	s->reg_writes++;
+
+	switch (reg) {
+	case SIM_REG_CHIP_ID_H:
+	case SIM_REG_CHIP_ID_L:
+		return;
+	case SIM_REG_SOFT_RESET:
+		/* 0xf0 resets the digital core; 0x00 releases it */
+		if (val & 0xf0) {
+			sim_power_on_reset(s);
+			s->resets++;
+		}
+		s->regs[reg] = val;
+		return;
+	case SIM_REG_MIPI_CTRL:
+		if (val == SIM_MIPI_ON && !s->streaming) {
+			s->streaming = true;
+			s->stream_start = ktime_get();
+			s->stream_starts++;
+		} else if (val != SIM_MIPI_ON) {
+			s->streaming = false;
+		}
+		break;
+	}
+
+	s->regs[reg] = val;
+}
+
+/* Time the bus would take for @len bytes plus the address byte */
+static void sim_bus_delay(unsigned int len)
+{
+	unsigned int khz = READ_ONCE(bus_khz);
+
+	if (khz)
+		fsleep(DIV_ROUND_UP((len + 1) * 9 * 1000, khz));
+}
+
+/*
+ * A write message carries a 16-bit register address and any number of
+ * values for consecutive registers. A read returns consecutive registers
+ * from the last address written, like the real part.
+ */
+static int sim_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs, int num)
+{
+	struct gc2607_sim *s = i2c_get_adapdata(adap);
+	int i, ret = num;
+
+	mutex_lock(&s->lock);
+
+	for (i = 0; i < num; i++) {
+		struct i2c_msg *msg = &msgs[i];
+		unsigned int j;
+
+		if (msg->addr != SIM_ADDR) {
+			ret = -ENXIO;
+			break;
+		}
+
+		sim_bus_delay(msg->len);
+		s->xfers++;
+		s->bytes += msg->len;
+
+		if (msg->flags & I2C_M_RD) {
+			if (s->addr + msg->len > SIM_NUM_REGS) {
+				ret = -EIO;
+				break;
+			}
+			for (j = 0; j < msg->len; j++)
+				msg->buf[j] = s->regs[s->addr++];
+			s->reg_reads += msg->len;
+			continue;
+		}
+
+		if (msg->len < 2) {
+			ret = -EIO;
+			break;
+		}
+		s->addr = get_unaligned_be16(msg->buf);
+		if (s->addr + msg->len - 2 > SIM_NUM_REGS) {
+			ret = -EIO;
+			break;
+		}
+		for (j = 2; j < msg->len; j++)
+			sim_write_reg(s, s->addr + j - 2, msg->buf[j]);
+	}
+
+	mutex_unlock(&s->lock);
+
+	return ret;
+}
+
+static u32 sim_functionality(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm sim_algo = {
+	.xfer = sim_xfer,
+	.functionality = sim_functionality,
+};
+
+/*
+ * Frames
+ *
+ * The scene is a horizontal ramp from 25% to 75% reflectance with a mild
+ * colour cast (red 90%, blue 70% of green), defined on the pixel array and
+ * read out through the flips, so the Bayer order follows 0x0101 the way it
+ * does on the sensor.
+ */
+struct sim_frame {
+	size_t size;
+	__le16 data[];
+};
+
+static u16 sim_pixel(const struct sim_state *st, u32 x, u32 y, u64 scale)
+{
+	u32 ax = st->hflip ? st->width - 1 - x : x;
+	u32 ay = st->vflip ? st->height - 1 - y : y;
+	u32 refl = 256 + div_u64(512ULL * ax, st->width);	/* Q10 */
+	u64 v;
+
+	/* GRBG on the array: G R on even rows, B G on odd rows */
+	if ((ay & 1) == 0 && (ax & 1) == 1)
+		refl = refl * 9 / 10;
+	else if ((ay & 1) == 1 && (ax & 1) == 0)
+		refl = refl * 7 / 10;
+
+	v = (refl * scale) >> 24;
+
+	return min_t(u64, v, 1023);
+}
+
+static int sim_frame_open(struct inode *inode, struct file *file)
+{
+	struct gc2607_sim *s = inode->i_private;
+	struct sim_frame *frame;
+	struct sim_state st;
+	u64 period, elapsed, scale, phase;
+	u32 x, y;
+
+	mutex_lock(&s->lock);
+	if (!s->streaming) {
+		mutex_unlock(&s->lock);
+		return -ENODATA;
+	}
+	sim_decode(s, &st);
+	period = sim_frame_ns(&st);
+	elapsed = ktime_to_ns(ktime_sub(ktime_get(), s->stream_start));
+	s->frames_read++;
+	mutex_unlock(&s->lock);
+
+	/* Deliver at the next frame boundary, so reads run at the frame rate */
+	div64_u64_rem(elapsed, period, &phase);
+	fsleep(div_u64(period - phase, NSEC_PER_USEC));
+
+	frame = vmalloc(struct_size(frame, data, st.width * st.height));
+	if (!frame)
+		return -ENOMEM;
+	frame->size = st.width * st.height * sizeof(u16);
+
+	/* pixel = refl(Q10) / 1024 * exposure * gain / 64 * light / 256 */
+	scale = (u64)st.exposure * st.gain * READ_ONCE(light);
+
+	for (y = 0; y < st.height; y++)
+		for (x = 0; x < st.width; x++)
+			frame->data[y * st.width + x] =
+				cpu_to_le16(sim_pixel(&st, x, y, scale));
+
+	file->private_data = frame;
+
+	return 0;
+}
+
+static ssize_t sim_frame_read(struct file *file, char __user *buf,
+			      size_t count, loff_t *ppos)
+{
+	struct sim_frame *frame = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, frame->data,
+				       frame->size);
+}
+
+static int sim_frame_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+	return 0;
+}
+
+static const struct file_operations sim_frame_fops = {
+	.owner = THIS_MODULE,
+	.open = sim_frame_open,
+	.read = sim_frame_read,
+	.release = sim_frame_release,
+	.llseek = default_llseek,
+};
+
+static int sim_status_show(struct seq_file *m, void *data)
+{
+	struct gc2607_sim *s = m->private;
+	struct sim_state st;
+	u64 period;
+
+	mutex_lock(&s->lock);
+	sim_decode(s, &st);
+	period = sim_frame_ns(&st);
+
+	seq_printf(m, "streaming %d\n", s->streaming);
+	seq_printf(m, "size %ux%u\n", st.width, st.height);
+	seq_printf(m, "vts %u\n", st.vts);
+	seq_printf(m, "frame_us %llu\n", div_u64(period, NSEC_PER_USEC));
+	seq_printf(m, "exposure %u\n", st.exposure);
+	seq_printf(m, "gain %u\n", st.gain);
+	seq_printf(m, "hflip %d\n", st.hflip);
+	seq_printf(m, "vflip %d\n", st.vflip);
+	seq_printf(m, "frames %llu\n", s->streaming ?
+		   div64_u64(ktime_to_ns(ktime_sub(ktime_get(), s->stream_start)),
+			     period) : 0);
+	seq_printf(m, "frames_read %llu\n", s->frames_read);
+	seq_printf(m, "i2c_transfers %llu\n", s->xfers);
+	seq_printf(m, "i2c_bytes %llu\n", s->bytes);
+	seq_printf(m, "reg_writes %llu\n", s->reg_writes);
+	seq_printf(m, "reg_reads %llu\n", s->reg_reads);
+	seq_printf(m, "soft_resets %llu\n", s->resets);
+	seq_printf(m, "stream_starts %llu\n", s->stream_starts);
+	mutex_unlock(&s->lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(sim_status);
+
+static int sim_regs_show(struct seq_file *m, void *data)
+{
+	struct gc2607_sim *s = m->private;
+	unsigned int i;
+
+	mutex_lock(&s->lock);
+	for (i = 0; i < SIM_NUM_REGS; i++)
+		if (s->regs[i])
+			seq_printf(m, "0x%04x 0x%02x\n", i, s->regs[i]);
+	mutex_unlock(&s->lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(sim_regs);
+
+static int sim_reset_set(void *data, u64 val)
+{
+	struct gc2607_sim *s = data;
+
+	mutex_lock(&s->lock);
+	s->xfers = 0;
+	s->bytes = 0;
+	s->reg_writes = 0;
+	s->reg_reads = 0;
+	s->resets = 0;
+	s->stream_starts = 0;
+	s->frames_read = 0;
+	mutex_unlock(&s->lock);
+
+	return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(sim_reset_fops, NULL, sim_reset_set, "%llu\n");
+
+static int sim_stream_get(void *data, u64 *val)
+{
+	struct gc2607_sim *s = data;
+
+	mutex_lock(&s->lock);
+	*val = s->streaming;
+	mutex_unlock(&s->lock);
+
+	return 0;
+}
+
+/* Stand-in for a receiver driver starting and stopping the sensor */
+static int sim_stream_set(void *data, u64 val)
+{
+	struct gc2607_sim *s = data;
+
+	if (!s->sd)
+		return -ENODEV;
+
+	return v4l2_subdev_call(s->sd, video, s_stream, !!val);
+}
+DEFINE_DEBUGFS_ATTRIBUTE(sim_stream_fops, sim_stream_get, sim_stream_set,
+			 "%llu\n");
+
+static void sim_debugfs_init(struct gc2607_sim *s)
+{
+	s->debugfs = debugfs_create_dir("gc2607-sim", NULL);
+
+	debugfs_create_file_unsafe("stream", 0600, s->debugfs, s,
+				   &sim_stream_fops);
+	debugfs_create_file("frame", 0400, s->debugfs, s, &sim_frame_fops);
+	debugfs_create_file("status", 0444, s->debugfs, s, &sim_status_fops);
+	debugfs_create_file("regs", 0444, s->debugfs, s, &sim_regs_fops);
+	debugfs_create_file_unsafe("reset", 0200, s->debugfs, s,
+				   &sim_reset_fops);
+}
+
+/*
+ * Bridge
+ */
+static int sim_notify_bound(struct v4l2_async_notifier *notifier,
+			    struct v4l2_subdev *sd,
+			    struct v4l2_async_connection *asc)
+{
+	struct gc2607_sim *s = container_of(notifier, struct gc2607_sim,
+					    notifier);
+
+	s->sd = sd;
+	dev_info(&s->adap.dev, "bound %s\n", sd->name);
+
+	return 0;
+}
+
+static void sim_notify_unbind(struct v4l2_async_notifier *notifier,
+			      struct v4l2_subdev *sd,
+			      struct v4l2_async_connection *asc)
+{
+	struct gc2607_sim *s = container_of(notifier, struct gc2607_sim,
+					    notifier);
+
+	s->sd = NULL;
+
+	/* The sensor loses its registers when the driver powers it down */
+	mutex_lock(&s->lock);
+	sim_power_on_reset(s);
+	mutex_unlock(&s->lock);
+}
+
+static int sim_notify_complete(struct v4l2_async_notifier *notifier)
+{
+	return v4l2_device_register_subdev_nodes(notifier->v4l2_dev);
+}
+
+static const struct v4l2_async_notifier_operations sim_notify_ops = {
+	.bound = sim_notify_bound,
+	.unbind = sim_notify_unbind,
+	.complete = sim_notify_complete,
+};
+
+static int __init gc2607_sim_init(void)
+{
+	struct i2c_board_info info = {
+		I2C_BOARD_INFO("gc2607", SIM_ADDR),
+	};
+	struct v4l2_async_connection *asc;
+	int ret;
+
+	sim = kzalloc(sizeof(*sim), GFP_KERNEL);
+	if (!sim)
+		return -ENOMEM;
+
+	mutex_init(&sim->lock);
+	sim_power_on_reset(sim);
+
+	sim->adap.owner = THIS_MODULE;
+	sim->adap.algo = &sim_algo;
+	strscpy(sim->adap.name, "GC2607 simulator", sizeof(sim->adap.name));
+	i2c_set_adapdata(&sim->adap, sim);
+
+	ret = i2c_add_adapter(&sim->adap);
+	if (ret)
+		goto err_free;
+
+	strscpy(sim->v4l2_dev.name, "gc2607-sim", sizeof(sim->v4l2_dev.name));
+	ret = v4l2_device_register(&sim->adap.dev, &sim->v4l2_dev);
+	if (ret)
+		goto err_del_adapter;
+
+	v4l2_async_nf_init(&sim->notifier, &sim->v4l2_dev);
+	sim->notifier.ops = &sim_notify_ops;
+	asc = v4l2_async_nf_add_i2c(&sim->notifier, i2c_adapter_id(&sim->adap),
+				    SIM_ADDR, struct v4l2_async_connection);
+	if (IS_ERR(asc)) {
+		ret = PTR_ERR(asc);
+		goto err_nf_cleanup;
+	}
+
+	ret = v4l2_async_nf_register(&sim->notifier);
+	if (ret)
+		goto err_nf_cleanup;
+
+	sim_debugfs_init(sim);
+
+	/* The driver binds to this through its id table, as on real hardware */
+	sim->client = i2c_new_client_device(&sim->adap, &info);
+	if (IS_ERR(sim->client)) {
+		ret = PTR_ERR(sim->client);
+		goto err_debugfs;
+	}
+
+	pr_info("gc2607-sim: sensor at %s, address 0x%02x\n",
+		dev_name(&sim->adap.dev), SIM_ADDR);
+
+	return 0;
+
+err_debugfs:
+	debugfs_remove_recursive(sim->debugfs);
+	v4l2_async_nf_unregister(&sim->notifier);
+err_nf_cleanup:
+	v4l2_async_nf_cleanup(&sim->notifier);
+	v4l2_device_unregister(&sim->v4l2_dev);
+err_del_adapter:
+	i2c_del_adapter(&sim->adap);
+err_free:
+	kfree(sim);
+	return ret;
+}
+
+static void __exit gc2607_sim_exit(void)
+{
+	debugfs_remove_recursive(sim->debugfs);
+	v4l2_async_nf_unregister(&sim->notifier);
+	v4l2_async_nf_cleanup(&sim->notifier);
+	i2c_unregister_device(sim->client);
+	v4l2_device_unregister(&sim->v4l2_dev);
+	i2c_del_adapter(&sim->adap);
+	kfree(sim);
+}
+
+module_init(gc2607_sim_init);
+module_exit(gc2607_sim_exit);
+
+MODULE_DESCRIPTION("Simulated GalaxyCore GC2607 sensor on a virtual I2C bus");
+MODULE_AUTHOR("Your Name <your.email@example.com>");
+MODULE_LICENSE("GPL");
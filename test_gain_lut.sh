@@ -5,8 +5,8 @@ set -e
 
 echo "=== Testing Gain LUT (Lower Noise) ==="
 echo ""
-echo "Gain control now uses LUT indices 0-16 for optimal noise performance"
-echo "Higher indices = more gain but still lower noise than before"
+echo "Gain control is linear (1/64 units); the values below are the LUT entries,"
+echo "which need no fine digital gain on top"
 echo ""
 
 # Reload driver with new gain LUT
@@ -22,20 +22,20 @@ echo ""
 mkdir -p test_lut
 cd test_lut
 
-echo "Testing gain LUT indices at max exposure (1335)..."
+echo "Testing gain LUT entries at max exposure (1335)..."
 echo ""
 
 EXPOSURE=1335
-# Test all gain indices, focusing on the higher range
-GAINS=(8 9 10 11 12 13 14 15 16)
+# LUT entries 8-16, the higher range
+GAINS=(253 304 367 434 510 607 717 847 1012)
 
 counter=1
 total=${#GAINS[@]}
 
 for gain in "${GAINS[@]}"; do
-    filename=$(printf "lut_exp%04d_gain%02d.png" $EXPOSURE $gain)
+    filename=$(printf "lut_exp%04d_gain%04d.png" $EXPOSURE $gain)
 
-    echo "[$counter/$total] Testing: exposure=$EXPOSURE, gain_index=$gain"
+    echo "[$counter/$total] Testing: exposure=$EXPOSURE, gain=$gain"
 
     # Set controls
     v4l2-ctl -d /dev/v4l-subdev6 --set-ctrl exposure=$EXPOSURE,analogue_gain=$gain 2>/dev/null
@@ -67,4 +67,4 @@ echo "The images should have:"
 echo "  ✓ Similar brightness to before"
 echo "  ✓ MUCH less grain/noise"
 echo ""
-echo "Pick the gain index that looks best!"
+echo "Pick the gain that looks best!"
@@ -0,0 +1,38 @@
+#!/bin/bash
+# Test pattern frames as a fixed input for the conversion pipeline
+#
+#   ./test_pattern.sh          # no camera needed: every converter kernel must
+#                              # produce the same output, then benchmark them
+
+set -e
+
+TOOLS="$(dirname "$0")/tools"
+PATTERNS=(bars black white red green blue pn9)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+if [ ! -x "$TOOLS/gc2607-pattern" ] || [ ! -x "$TOOLS/gc2607-convert" ]; then
+    echo "Building tools..."
+    make -C "$TOOLS"
+fi
+
+echo "=== Converter regression (no camera) ==="
+for p in "${PATTERNS[@]}"; do
+    "$TOOLS/gc2607-pattern" -n 10 "$p" "$WORK/$p.raw"
+    ref=""
+    for k in $("$TOOLS/gc2607-convert" --help 2>&1 | sed -n 's/.*Force a kernel: *//p'); do
+        "$TOOLS/gc2607-convert" -k "$k" "$WORK/$p.raw" "$WORK/out.yuv" 2>/dev/null
+        sum=$(md5sum < "$WORK/out.yuv" | cut -d' ' -f1)
+        if [ -z "$ref" ]; then
+            ref=$sum
+        elif [ "$sum" != "$ref" ]; then
+            echo "❌ $p: $k kernel differs"
+            exit 1
+        fi
+    done
+    echo "  $p: $ref"
+done
+echo ""
+
+echo "=== Converter benchmark (pn9, 10 frames) ==="
+"$TOOLS/gc2607-convert" --bench "$WORK/pn9.raw"
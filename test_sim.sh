@@ -0,0 +1,132 @@
+#!/bin/bash
+# Benchmark the driver against the simulated sensor (sim/gc2607-sim.ko):
+# stream-start latency, control throughput and register traffic, plus a
+# check that frame brightness follows exposure and gain. No camera needed.
+
+set -e
+
+RUNS=${1:-10}
+CTRLS=${2:-200}
+
+SIM=/sys/kernel/debug/gc2607-sim
+
+echo "=== GC2607 Simulator Benchmark ==="
+echo ""
+
+if [ ! -f sim/gc2607-sim.ko ]; then
+    echo "Building simulator..."
+    make -C sim
+fi
+
+# The simulator must be loaded after the driver, or the client binds later
+sudo rmmod gc2607-sim 2>/dev/null || true
+sudo rmmod gc2607 2>/dev/null || true
+sudo modprobe v4l2-async
+sudo insmod gc2607.ko
+sudo insmod sim/gc2607-sim.ko "bus_khz=${BUS_KHZ:-400}"
+
+SENSOR_DEV=$(ls -d /sys/bus/i2c/drivers/gc2607/*-0037 2>/dev/null | head -1)
+if [ -z "$SENSOR_DEV" ]; then
+    echo "Error: gc2607 did not bind to the simulator"
+    sudo dmesg | grep -i gc2607 | tail -10
+    exit 1
+fi
+STATS=/sys/kernel/debug/i2c/$(basename "$(dirname "$(readlink -f "$SENSOR_DEV")")")/$(basename "$SENSOR_DEV")
+
+SUBDEV=""
+for n in /sys/class/video4linux/v4l-subdev*; do
+    grep -q gc2607 "$n/name" 2>/dev/null && SUBDEV=/dev/$(basename "$n")
+done
+echo "Sensor device: $SENSOR_DEV"
+echo "Subdev node:   ${SUBDEV:-none}"
+echo ""
+
+sim_stat() {
+    sudo awk -v k="$1" '$1 == k { print $2 }' $SIM/status
+}
+
+now_us() {
+    echo $(( $(date +%s%N) / 1000 ))
+}
+
+# Stream-start latency: full init (sensor suspended) and fast restart
+DELAY_MS=$(cat "$SENSOR_DEV/power/autosuspend_delay_ms")
+echo 0 | sudo tee "$SENSOR_DEV/power/autosuspend_delay_ms" > /dev/null
+
+stream_on_us() {
+    local start end
+    start=$(now_us)
+    echo 1 | sudo tee $SIM/stream > /dev/null
+    end=$(now_us)
+    echo 0 | sudo tee $SIM/stream > /dev/null
+    echo $((end - start))
+}
+
+measure() {
+    local label=$1 total=0 us i xfers
+    echo 1 | sudo tee $SIM/reset > /dev/null
+    for i in $(seq 1 "$RUNS"); do
+        us=$(stream_on_us)
+        total=$((total + us))
+    done
+    xfers=$(sim_stat i2c_transfers)
+    echo "  $label: average $((total / RUNS)) us," \
+         "$((xfers / RUNS)) transfers, $(( $(sim_stat i2c_bytes) / RUNS )) bytes per start"
+}
+
+echo 1 | sudo tee $STATS/stats_reset > /dev/null
+echo "=== Stream start (${RUNS} runs) ==="
+measure "full init   "
+echo "$DELAY_MS" | sudo tee "$SENSOR_DEV/power/autosuspend_delay_ms" > /dev/null
+echo 1 | sudo tee $SIM/stream > /dev/null
+echo 0 | sudo tee $SIM/stream > /dev/null
+measure "fast restart"
+echo ""
+
+# Control throughput, with the sensor powered so every write reaches the bus
+if [ -n "$SUBDEV" ]; then
+    echo "=== Control throughput (${CTRLS} exposure writes) ==="
+    echo 1 | sudo tee $SIM/stream > /dev/null
+    echo 1 | sudo tee $SIM/reset > /dev/null
+    start=$(now_us)
+    for i in $(seq 1 "$CTRLS"); do
+        v4l2-ctl -d "$SUBDEV" --set-ctrl exposure=$(( 100 + i ))
+    done
+    end=$(now_us)
+    echo "  $(( (end - start) / CTRLS )) us per control (including v4l2-ctl)," \
+         "$(( $(sim_stat i2c_transfers) / CTRLS )) transfers," \
+         "$(( $(sim_stat reg_writes) / CTRLS )) register writes each"
+    echo ""
+
+    # Brightness must track exposure: doubling it doubles the mean
+    echo "=== Frame brightness ==="
+    mean() {
+        sudo cat $SIM/frame | python3 -c '
+import array, sys
+a = array.array("H", sys.stdin.buffer.read())
+print(sum(a) / len(a))'
+    }
+    v4l2-ctl -d "$SUBDEV" --set-ctrl exposure=500,analogue_gain=64
+    m1=$(mean)
+    v4l2-ctl -d "$SUBDEV" --set-ctrl exposure=1000
+    m2=$(mean)
+    v4l2-ctl -d "$SUBDEV" --set-ctrl analogue_gain=128
+    m3=$(mean)
+    echo "  exposure 500:            $m1"
+    echo "  exposure 1000:           $m2"
+    echo "  exposure 1000, gain 2x:  $m3"
+    python3 -c "
+import sys
+r1, r2 = $m2 / $m1, $m3 / $m2
+print('  ratios %.3f %.3f' % (r1, r2))
+sys.exit(0 if abs(r1 - 2) < 0.05 and abs(r2 - 2) < 0.05 else 1)" ||
+        { echo "FAIL: brightness does not follow exposure and gain"; exit 1; }
+    echo 0 | sudo tee $SIM/stream > /dev/null
+    echo ""
+fi
+
+echo "Driver statistics:"
+sudo cat $STATS/stats | grep -E 'i2c_transfers|i2c_bytes|stream_on|Exposure'
+echo ""
+echo "Simulator:"
+sudo cat $SIM/status
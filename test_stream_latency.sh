@@ -0,0 +1,70 @@
+#!/bin/bash
+# Measure STREAMON-to-first-frame latency for a full sensor initialization
+# versus a fast restart (sensor still powered within the runtime PM
+# autosuspend delay, only MIPI output toggled)
+
+set -e
+
+RUNS=${1:-5}
+
+echo "=== GC2607 Stream Start Latency ==="
+echo ""
+
+# Check if modules are loaded
+if ! lsmod | grep -q gc2607; then
+    echo "Error: gc2607 module not loaded"
+    exit 1
+fi
+
+# Find the sensor's I2C device for runtime PM control
+SENSOR_DEV=$(ls -d /sys/bus/i2c/drivers/gc2607/*-* 2>/dev/null | head -1)
+if [ -z "$SENSOR_DEV" ]; then
+    echo "Error: Could not find gc2607 I2C device in sysfs"
+    exit 1
+fi
+echo "Sensor device: $SENSOR_DEV"
+
+# Setup format and link
+echo "Setting up video format and media link..."
+v4l2-ctl -d /dev/video0 --set-fmt-video=width=1920,height=1080,pixelformat=BA10
+media-ctl -d /dev/media0 -l '"Intel IPU6 CSI2 0":1 -> "Intel IPU6 ISYS Capture 0":0[1]'
+echo ""
+
+# Capture one frame and print the elapsed time in milliseconds
+first_frame_ms() {
+    local start end
+    start=$(date +%s%N)
+    v4l2-ctl -d /dev/video0 --stream-mmap --stream-count=1 --stream-to=/dev/null 2>/dev/null
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+# Seconds to wait for runtime PM to power the sensor off between streams
+DELAY_MS=$(cat "$SENSOR_DEV/power/autosuspend_delay_ms" 2>/dev/null || echo 0)
+SUSPEND_WAIT=$(( DELAY_MS / 1000 + 1 ))
+echo "Autosuspend delay: ${DELAY_MS} ms"
+
+measure() {
+    local label=$1 total=0 ms i
+    for i in $(seq 1 "$RUNS"); do
+        [ "$label" = "full" ] && sleep "$SUSPEND_WAIT"
+        ms=$(first_frame_ms)
+        total=$((total + ms))
+        echo "  run $i: ${ms} ms"
+    done
+    echo "  average: $((total / RUNS)) ms"
+}
+
+# Full initialization: wait out the autosuspend delay between streams
+echo "=== Full initialization (sensor powered off between runs) ==="
+measure full
+echo ""
+
+# Fast restart: reopen within the autosuspend delay so registers stay valid
+echo "=== Fast restart (back-to-back runs) ==="
+first_frame_ms > /dev/null  # program the sensor once
+measure fast
+echo ""
+
+echo "Driver-side STREAMON timings:"
+sudo dmesg | grep "gc2607.*Stream ON" | tail -$((RUNS * 2 + 1))
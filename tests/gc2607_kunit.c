@@ -0,0 +1,962 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * KUnit tests for the GC2607 driver
+ *
+ * Included at the end of gc2607.c when GC2607_KUNIT is defined, so the
+ * static functions are in reach. Each test gets a mock I2C adapter with a
+ * register file at 0x37, and the driver binds to it through the I2C core
+ * as it does on hardware. Power sequencing is stubbed out, so no GPIOs,
+ * clocks or regulators are involved and the stubs can count power on/off
+ * calls.
+ *
+ * The benchmark cases print timings for table programming, control writes
+ * and stream start against the mock, which costs nothing per transfer, so
+ * they measure the driver's own overhead. Run with tests/run_kunit.sh.
+ */
+
+#include <kunit/static_stub.h>
+#include <kunit/test.h>
+
+#define GC2607_TEST_ADDR		0x37
+#define GC2607_TEST_LOG			4096
+
+struct gc2607_test_write {
+	u16 reg;
+	u8 val;
+};
+
+struct gc2607_test_bus {
+	struct i2c_adapter adap;
+	struct i2c_client *client;
+	u8 regs[GC2607_REG_MAX + 1];
+	u16 addr;			/* Register pointer for reads */
+
+	/* Completed transfers, and the messages and bytes in them */
+	unsigned int xfers;
+	unsigned int msgs;
+	unsigned int bytes;
+	unsigned int max_xfer_msgs;
+	unsigned int max_xfer_bytes;
+	unsigned int max_msg_len;
+
+	int fail_from;			/* Fail every transfer from this one on */
+	unsigned int fail_next;		/* Fail this many attempts, then recover */
+	bool fail_power;
+
+	int powered;			/* Stubbed power on minus power off */
+	unsigned int power_ons;
+
+	unsigned int nlog;		/* Register writes, in bus order */
+	struct gc2607_test_write log[GC2607_TEST_LOG];
+};
+
+/* Power-on register state: zero except for the chip ID */
+static void gc2607_test_reset_regs(struct gc2607_test_bus *bus)
+{
+	memset(bus->regs, 0, sizeof(bus->regs));
+	bus->regs[GC2607_REG_CHIP_ID_H] = GC2607_CHIP_ID_H;
+	bus->regs[GC2607_REG_CHIP_ID_L] = GC2607_CHIP_ID_L;
+	bus->regs[GC2607_REG_MIPI_CTRL] = GC2607_MIPI_STREAM_OFF;
+}
+
+static void gc2607_test_clear_counts(struct gc2607_test_bus *bus)
+{
+	bus->xfers = 0;
+	bus->msgs = 0;
+	bus->bytes = 0;
+	bus->max_xfer_msgs = 0;
+	bus->max_xfer_bytes = 0;
+	bus->max_msg_len = 0;
+	bus->nlog = 0;
+}
+
+static void gc2607_test_write_reg(struct gc2607_test_bus *bus, u16 reg, u8 val)
+{
+	if (bus->nlog < GC2607_TEST_LOG)
+		bus->log[bus->nlog++] = (struct gc2607_test_write){ reg, val };
+
+	/* Soft reset returns the digital core to its power-on state */
+	if (reg == GC2607_REG_SOFT_RESET && (val & 0xf0)) {
+		gc2607_test_reset_regs(bus);
+		return;
+	}
+
+	if (reg != GC2607_REG_CHIP_ID_H && reg != GC2607_REG_CHIP_ID_L)
+		bus->regs[reg] = val;
+}
+
+/* 16-bit address then data for writes; reads continue from the address */
+static int gc2607_test_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
+			    int num)
+{
+	struct gc2607_test_bus *bus = i2c_get_adapdata(adap);
+	unsigned int bytes = 0;
+	int i, j;
+
+	if (bus->fail_next) {
+		bus->fail_next--;
+		return -EREMOTEIO;
+	}
+	if (bus->fail_from >= 0 && bus->xfers >= bus->fail_from)
+		return -EREMOTEIO;
+
+	for (i = 0; i < num; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (msg->addr != GC2607_TEST_ADDR)
+			return -ENXIO;
+
+		bytes += msg->len;
+		bus->max_msg_len = max_t(unsigned int, bus->max_msg_len,
+					 msg->len);
+
+		if (msg->flags & I2C_M_RD) {
+			if (bus->addr + msg->len > sizeof(bus->regs))
+				return -EIO;
+			memcpy(msg->buf, &bus->regs[bus->addr], msg->len);
+			bus->addr += msg->len;
+			continue;
+		}
+
+		if (msg->len < 2)
+			return -EIO;
+		bus->addr = get_unaligned_be16(msg->buf);
+		if (bus->addr + msg->len - 2 > sizeof(bus->regs))
+			return -EIO;
+		for (j = 2; j < msg->len; j++)
+			gc2607_test_write_reg(bus, bus->addr + j - 2, msg->buf[j]);
+	}
+
+	bus->xfers++;
+	bus->msgs += num;
+	bus->bytes += bytes;
+	bus->max_xfer_msgs = max_t(unsigned int, bus->max_xfer_msgs, num);
+	bus->max_xfer_bytes = max(bus->max_xfer_bytes, bytes);
+
+	return num;
+}
+
+static u32 gc2607_test_functionality(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm gc2607_test_algo = {
+	.xfer = gc2607_test_xfer,
+	.functionality = gc2607_test_functionality,
+};
+
+static struct gc2607_test_bus *gc2607_test_bus_of(struct gc2607 *gc2607)
+{
+	return i2c_get_adapdata(gc2607->client->adapter);
+}
+
+/* Power sequencing stubs; the sensor loses its registers with power */
+static int gc2607_test_power_on(struct gc2607 *gc2607)
+{
+	struct gc2607_test_bus *bus = gc2607_test_bus_of(gc2607);
+
+	if (bus->fail_power)
+		return -EIO;
+
+	bus->powered++;
+	bus->power_ons++;
+	gc2607->powered = true;
+	return 0;
+}
+
+static void gc2607_test_power_off(struct gc2607 *gc2607)
+{
+	struct gc2607_test_bus *bus = gc2607_test_bus_of(gc2607);
+
+	if (!gc2607->powered)
+		return;
+
+	bus->powered--;
+	gc2607->powered = false;
+	gc2607_test_reset_regs(bus);
+}
+
+static int gc2607_test_init(struct kunit *test)
+{
+	struct gc2607_test_bus *bus;
+	int ret;
+
+	bus = kunit_kzalloc(test, sizeof(*bus), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, bus);
+
+	bus->fail_from = -1;
+	gc2607_test_reset_regs(bus);
+
+	bus->adap.owner = THIS_MODULE;
+	bus->adap.algo = &gc2607_test_algo;
+	strscpy(bus->adap.name, "gc2607-kunit", sizeof(bus->adap.name));
+	i2c_set_adapdata(&bus->adap, bus);
+
+	ret = i2c_add_adapter(&bus->adap);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	kunit_activate_static_stub(test, gc2607_power_on, gc2607_test_power_on);
+	kunit_activate_static_stub(test, gc2607_power_off,
+				   gc2607_test_power_off);
+
+	test->priv = bus;
+	return 0;
+}
+
+static void gc2607_test_exit(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	if (bus->client)
+		i2c_unregister_device(bus->client);
+	i2c_del_adapter(&bus->adap);
+}
+
+/*
+ * Keep runtime PM from suspending the sensor behind a test's back; the
+ * autosuspend work would run outside the test and miss the power stubs.
+ */
+static int gc2607_test_saved_delay_ms;
+
+static int gc2607_test_suite_init(struct kunit_suite *suite)
+{
+	gc2607_test_saved_delay_ms = autosuspend_delay_ms;
+	autosuspend_delay_ms = 60 * MSEC_PER_SEC;
+	return 0;
+}
+
+static void gc2607_test_suite_exit(struct kunit_suite *suite)
+{
+	autosuspend_delay_ms = gc2607_test_saved_delay_ms;
+}
+
+/* Instantiate the sensor on the mock bus; NULL if the probe failed */
+static struct gc2607 *gc2607_test_bind(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+	struct i2c_board_info info = {
+		I2C_BOARD_INFO("gc2607", GC2607_TEST_ADDR),
+	};
+
+	bus->client = i2c_new_client_device(&bus->adap, &info);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, bus->client);
+
+	if (!bus->client->dev.driver)
+		return NULL;
+
+	return to_gc2607(i2c_get_clientdata(bus->client));
+}
+
+static void gc2607_test_unbind(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	i2c_unregister_device(bus->client);
+	bus->client = NULL;
+}
+
+/*
+ * Bind, and hold the sensor powered for the rest of the test. The runtime
+ * PM reference goes away with the device.
+ */
+static struct gc2607 *gc2607_test_bind_active(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind(test);
+	int ret;
+
+	KUNIT_ASSERT_NOT_NULL(test, gc2607);
+
+	ret = pm_runtime_resume_and_get(&gc2607->client->dev);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+
+	gc2607_test_clear_counts(test->priv);
+	return gc2607;
+}
+
+static u16 gc2607_test_reg16(struct gc2607_test_bus *bus, u16 reg)
+{
+	return (bus->regs[reg] << 8) | bus->regs[reg + 1];
+}
+
+/*
+ * gc2607_write_array()
+ */
+static void gc2607_test_write_array_bursts(struct kunit *test)
+{
+	static const struct gc2607_regval regs[] = {
+		{0x0d80, 0x07},
+		{0x0d81, 0x02},
+		{0x0d82, 0x14},
+		{0x0e17, 0x26},
+		{GC2607_REG_END, 0x00},
+	};
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+
+	/* One transfer: a 3-register burst and a single write */
+	KUNIT_EXPECT_EQ(test, bus->xfers, 1);
+	KUNIT_EXPECT_EQ(test, bus->msgs, 2);
+	KUNIT_EXPECT_EQ(test, bus->bytes, (2 + 3) + (2 + 1));
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d80], 0x07);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d81], 0x02);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d82], 0x14);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0e17], 0x26);
+}
+
+static void gc2607_test_write_array_order(struct kunit *test)
+{
+	static const struct gc2607_regval regs[] = {
+		{GC2607_REG_SOFT_RESET, 0xf0},
+		{GC2607_REG_SOFT_RESET, 0xf0},
+		{GC2607_REG_SOFT_RESET, 0x00},
+		{GC2607_REG_SOFT_RESET, 0x00},
+		{GC2607_REG_END, 0x00},
+	};
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+	unsigned int i;
+
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+
+	/* Repeated writes to one register stay separate and in order */
+	KUNIT_ASSERT_EQ(test, bus->nlog, ARRAY_SIZE(regs) - 1);
+	for (i = 0; i < bus->nlog; i++) {
+		KUNIT_EXPECT_EQ(test, bus->log[i].reg, regs[i].addr);
+		KUNIT_EXPECT_EQ(test, bus->log[i].val, regs[i].val);
+	}
+
+	/* Soft reset writes are not batched, and nothing joins them */
+	KUNIT_EXPECT_EQ(test, bus->msgs, bus->nlog);
+	KUNIT_EXPECT_EQ(test, bus->xfers, bus->nlog);
+}
+
+static void gc2607_test_write_array_end(struct kunit *test)
+{
+	static const struct gc2607_regval regs[] = {
+		{0x0d80, 0x07},
+		{GC2607_REG_END, 0x00},
+		{0x0d81, 0x02},
+	};
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+	KUNIT_EXPECT_EQ(test, bus->nlog, 1);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d81], 0);
+
+	/* An empty table does not touch the bus */
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, &regs[1]), 0);
+	KUNIT_EXPECT_EQ(test, bus->xfers, 1);
+}
+
+static void gc2607_test_write_array_delay(struct kunit *test)
+{
+	static const struct gc2607_regval regs[] = {
+		{0x0d80, 0x07},
+		{GC2607_REG_DELAY, 20},
+		{0x0d81, 0x02},
+		{GC2607_REG_END, 0x00},
+	};
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+	ktime_t start = ktime_get();
+
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+
+	/* The delay flushes, so consecutive registers are not merged */
+	KUNIT_EXPECT_GE(test, ktime_ms_delta(ktime_get(), start), 20);
+	KUNIT_EXPECT_EQ(test, bus->xfers, 2);
+	KUNIT_EXPECT_EQ(test, bus->nlog, 2);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0000], 0);
+}
+
+static void gc2607_test_write_array_split(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+	struct gc2607_regval *regs;
+	unsigned int i, n = 300;
+
+	regs = kunit_kcalloc(test, n + 1, sizeof(*regs), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, regs);
+	for (i = 0; i < n; i++)
+		regs[i] = (struct gc2607_regval){ 0x0a00 + i, i & 0xff };
+	regs[n].addr = GC2607_REG_END;
+
+	KUNIT_ASSERT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+
+	for (i = 0; i < n; i++)
+		KUNIT_EXPECT_EQ(test, bus->regs[0x0a00 + i], i & 0xff);
+	KUNIT_EXPECT_EQ(test, bus->msgs, DIV_ROUND_UP(n, GC2607_BURST_MAX));
+	KUNIT_EXPECT_LE(test, bus->max_msg_len, 2 + GC2607_BURST_MAX);
+	KUNIT_EXPECT_LE(test, bus->max_xfer_msgs, GC2607_BATCH_MSGS);
+	KUNIT_EXPECT_LE(test, bus->max_xfer_bytes, GC2607_BATCH_BUF_SIZE);
+}
+
+static void gc2607_test_write_array_error(struct kunit *test)
+{
+	static const struct gc2607_regval regs[] = {
+		{0x0d80, 0x07},
+		{GC2607_REG_DELAY, 1},
+		{0x0d81, 0x02},
+		{GC2607_REG_END, 0x00},
+	};
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+
+	/* A transient failure is retried through */
+	bus->fail_next = GC2607_I2C_RETRIES;
+	KUNIT_EXPECT_EQ(test, gc2607_write_array(gc2607, regs), 0);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d81], 0x02);
+
+	/* A persistent one is returned, and nothing after it is written */
+	gc2607_test_reset_regs(bus);
+	bus->fail_next = GC2607_I2C_RETRIES + 1;
+	KUNIT_EXPECT_EQ(test, gc2607_write_array(gc2607, regs), -EREMOTEIO);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d80], 0);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d81], 0);
+
+	/* An error after the delay stops the table there */
+	gc2607_test_clear_counts(bus);
+	bus->fail_from = 1;
+	KUNIT_EXPECT_EQ(test, gc2607_write_array(gc2607, regs), -EREMOTEIO);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d80], 0x07);
+	KUNIT_EXPECT_EQ(test, bus->regs[0x0d81], 0);
+}
+
+/*
+ * gc2607_write_segs()
+ */
+
+/* Check the bus log from @start against @segs, write for write */
+static unsigned int gc2607_test_expect_segs(struct kunit *test,
+					    unsigned int start, const u8 *segs)
+{
+	struct gc2607_test_bus *bus = test->priv;
+	unsigned int i, n = start, reg;
+	const u8 *seg;
+
+	gc2607_for_each_seg(seg, segs) {
+		reg = get_unaligned_be16(seg + 1);
+		for (i = 0; i < seg[0]; i++, n++) {
+			KUNIT_ASSERT_LT(test, n, bus->nlog);
+			KUNIT_EXPECT_EQ_MSG(test, bus->log[n].reg, reg + i,
+					    "write %u", n);
+			KUNIT_EXPECT_EQ_MSG(test, bus->log[n].val, seg[3 + i],
+					    "reg 0x%04x", reg + i);
+		}
+	}
+
+	return n;
+}
+
+/*
+ * A full init writes every compiled register in table order, repeated
+ * writes included; the full-size window matches the table's.
+ */
+static void gc2607_test_init_segs(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+
+	KUNIT_ASSERT_EQ(test, gc2607_sync_regs(gc2607), 0);
+	KUNIT_EXPECT_EQ(test, gc2607_test_expect_segs(test, 0, gc2607_init_segs),
+			bus->nlog);
+
+	/* Batched: several messages per transfer, within the burst limit */
+	KUNIT_EXPECT_LT(test, bus->xfers, bus->msgs);
+	KUNIT_EXPECT_LE(test, bus->max_xfer_msgs, GC2607_BATCH_MSGS);
+	KUNIT_EXPECT_LE(test, bus->max_msg_len, 2 + GC2607_BURST_MAX);
+}
+
+/*
+ * The post-stream registers follow the stream enable on a full init, and
+ * a restart, which keeps the programmed state, does not write them again.
+ */
+static void gc2607_test_init_post_segs(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	struct gc2607_test_bus *bus = test->priv;
+	unsigned int i;
+
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+	for (i = 0; i < bus->nlog; i++)
+		if (bus->log[i].reg == GC2607_REG_MIPI_CTRL &&
+		    bus->log[i].val == GC2607_MIPI_STREAM_ON)
+			break;
+	KUNIT_EXPECT_EQ(test, gc2607_test_expect_segs(test, i + 1,
+						      gc2607_init_post_segs),
+			bus->nlog);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(sd, 0), 0);
+
+	gc2607_test_clear_counts(bus);
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+	KUNIT_EXPECT_EQ(test, bus->nlog, 1);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(sd, 0), 0);
+}
+
+/*
+ * Gain mapping in gc2607_s_ctrl(). The expected registers are spelled out
+ * rather than computed from gc2607_gain_table, so a table edit shows up.
+ */
+struct gc2607_test_gain {
+	u32 gain;
+	u32 dgain;
+	u8 reg2b3;
+	u8 reg2b4;
+	u16 reg20c;
+};
+
+static const struct gc2607_test_gain gc2607_test_gains[] = {
+	/* Every LUT entry writes the reference registers */
+	{  64,  64, 0x00, 0x00, 0x0040},
+	{  76,  64, 0x05, 0x00, 0x004b},
+	{  93,  64, 0x00, 0x01, 0x0059},
+	{ 111,  64, 0x05, 0x01, 0x006a},
+	{ 130,  64, 0x00, 0x02, 0x0080},
+	{ 156,  64, 0x05, 0x02, 0x0097},
+	{ 184,  64, 0x00, 0x03, 0x00b3},
+	{ 221,  64, 0x05, 0x03, 0x00d4},
+	{ 253,  64, 0x00, 0x04, 0x0100},
+	{ 304,  64, 0x05, 0x04, 0x012f},
+	{ 367,  64, 0x00, 0x05, 0x0166},
+	{ 434,  64, 0x05, 0x05, 0x01a8},
+	{ 510,  64, 0x00, 0x06, 0x0200},
+	{ 607,  64, 0x05, 0x06, 0x025e},
+	{ 717,  64, 0x09, 0x26, 0x02cc},
+	{ 847,  64, 0x0c, 0xb6, 0x0350},
+	{1012,  64, 0x10, 0x06, 0x0400},
+	/* Between entries the lower one is scaled up by 0x020c/0x020d */
+	{ 128,  64, 0x05, 0x01, 0x007a},
+	{ 700,  64, 0x05, 0x06, 0x02bb},
+	{ 900,  64, 0x0c, 0xb6, 0x0385},
+	/* Digital gain scales again, clamped to the 12-bit register */
+	{  64, 128, 0x00, 0x00, 0x0080},
+	{ 717, 100, 0x09, 0x26, 0x045f},
+	{1012, 256, 0x10, 0x06, 0x0fff},
+};
+
+static void gc2607_test_gain_desc(const struct gc2607_test_gain *t, char *desc)
+{
+	snprintf(desc, KUNIT_PARAM_DESC_SIZE, "gain %u dgain %u", t->gain,
+		 t->dgain);
+}
+
+KUNIT_ARRAY_PARAM(gc2607_test_gain, gc2607_test_gains, gc2607_test_gain_desc);
+
+static void gc2607_test_ctrl_gain(struct kunit *test)
+{
+	const struct gc2607_test_gain *t = test->param_value;
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct gc2607_test_bus *bus = test->priv;
+	unsigned int xfers;
+
+	KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->gain, t->gain), 0);
+	KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->digital_gain,
+						 t->dgain), 0);
+
+	/* Change the exposure too, so the cluster is written at least once */
+	xfers = bus->xfers;
+	KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->exposure, 1000),
+			0);
+
+	/* Exposure and all four gain registers in a single transfer */
+	KUNIT_EXPECT_EQ(test, bus->xfers - xfers, 1);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(bus, GC2607_REG_EXPOSURE_H), 1000);
+	KUNIT_EXPECT_EQ(test, bus->regs[GC2607_REG_AGAIN_H], t->reg2b3);
+	KUNIT_EXPECT_EQ(test, bus->regs[GC2607_REG_AGAIN_L], t->reg2b4);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(bus, GC2607_REG_DGAIN_H),
+			t->reg20c);
+}
+
+/* Controls set while suspended reach the sensor at the next stream start */
+static void gc2607_test_ctrl_replay(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind(test);
+	struct gc2607_test_bus *bus = test->priv;
+	struct device *dev;
+
+	KUNIT_ASSERT_NOT_NULL(test, gc2607);
+	dev = &gc2607->client->dev;
+
+	KUNIT_ASSERT_EQ(test, pm_runtime_suspend(dev), 0);
+	KUNIT_EXPECT_EQ(test, bus->powered, 0);
+
+	gc2607_test_clear_counts(bus);
+	KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->exposure, 1234),
+			0);
+	KUNIT_EXPECT_EQ(test, bus->xfers, 0);
+
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(&gc2607->sd, 1), 0);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(bus, GC2607_REG_EXPOSURE_H), 1234);
+	KUNIT_EXPECT_EQ(test, bus->regs[GC2607_REG_MIPI_CTRL],
+			GC2607_MIPI_STREAM_ON);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(&gc2607->sd, 0), 0);
+	KUNIT_EXPECT_EQ(test, bus->regs[GC2607_REG_MIPI_CTRL],
+			GC2607_MIPI_STREAM_OFF);
+}
+
+/*
+ * Formats: gc2607_enum_frame_size() and gc2607_set_fmt()
+ */
+static void gc2607_test_enum_frame_size(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	struct v4l2_subdev_frame_size_enum fse = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.code = MEDIA_BUS_FMT_SGRBG10_1X10,
+	};
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(gc2607_modes); i++) {
+		fse.index = i;
+		KUNIT_ASSERT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+				enum_frame_size, &fse), 0);
+		KUNIT_EXPECT_EQ(test, fse.min_width, gc2607_modes[i].width);
+		KUNIT_EXPECT_EQ(test, fse.max_width, gc2607_modes[i].width);
+		KUNIT_EXPECT_EQ(test, fse.min_height, gc2607_modes[i].height);
+		KUNIT_EXPECT_EQ(test, fse.max_height, gc2607_modes[i].height);
+	}
+
+	/* Past the last mode, and with the wrong Bayer order */
+	fse.index = i;
+	KUNIT_EXPECT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+			enum_frame_size, &fse), -EINVAL);
+	fse.index = 0;
+	fse.code = MEDIA_BUS_FMT_SRGGB10_1X10;
+	KUNIT_EXPECT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+			enum_frame_size, &fse), -EINVAL);
+
+	/* The code follows the flips */
+	KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->hflip, 1), 0);
+	KUNIT_EXPECT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+			enum_frame_size, &fse), 0);
+}
+
+struct gc2607_test_fmt {
+	u32 width;
+	u32 height;
+	u32 expect_width;
+	u32 expect_height;
+};
+
+static const struct gc2607_test_fmt gc2607_test_fmts[] = {
+	{1920, 1080, 1920, 1080},
+	{1280,  720, 1920, 1080},
+	{4000, 3000, 1920, 1080},
+	{ 640,  480, 1920, 1080},
+	{   0,    0, 1920, 1080},
+};
+
+static void gc2607_test_fmt_desc(const struct gc2607_test_fmt *t, char *desc)
+{
+	snprintf(desc, KUNIT_PARAM_DESC_SIZE, "%ux%u", t->width, t->height);
+}
+
+KUNIT_ARRAY_PARAM(gc2607_test_fmt, gc2607_test_fmts, gc2607_test_fmt_desc);
+
+static void gc2607_test_set_fmt(struct kunit *test)
+{
+	const struct gc2607_test_fmt *t = test->param_value;
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	const struct gc2607_mode *mode;
+	struct v4l2_subdev_format fmt = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.format = {
+			.width = t->width,
+			.height = t->height,
+			.code = MEDIA_BUS_FMT_SBGGR8_1X8,
+		},
+	};
+
+	KUNIT_ASSERT_EQ(test, v4l2_subdev_call_state_active(sd, pad, set_fmt,
+							    &fmt), 0);
+	KUNIT_EXPECT_EQ(test, fmt.format.width, t->expect_width);
+	KUNIT_EXPECT_EQ(test, fmt.format.height, t->expect_height);
+	KUNIT_EXPECT_EQ(test, fmt.format.code, MEDIA_BUS_FMT_SGRBG10_1X10);
+	KUNIT_EXPECT_EQ(test, fmt.format.field, V4L2_FIELD_NONE);
+
+	/* The frame timing follows the mode */
+	mode = gc2607_find_mode(&(struct v4l2_rect){ 0, 0, t->expect_width,
+						     t->expect_height });
+	KUNIT_EXPECT_EQ(test, gc2607->vblank->val, mode->vts - mode->height);
+	KUNIT_EXPECT_EQ(test, gc2607->exposure->maximum, mode->vts - 1);
+	KUNIT_EXPECT_EQ(test, gc2607->hblank->val, mode->hts - mode->width);
+
+	/* The window is cached and reaches the sensor at stream start */
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(test->priv,
+						GC2607_REG_COL_COUNT_H),
+			t->expect_width);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(test->priv,
+						GC2607_REG_ROW_COUNT_H),
+			t->expect_height + GC2607_ROW_MARGIN);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(sd, 0), 0);
+}
+
+/* A smaller output is a crop, which set_fmt keeps when its size is asked */
+static void gc2607_test_set_selection(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	struct v4l2_subdev_selection sel = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.target = V4L2_SEL_TGT_CROP,
+		.r = { 321, 181, 1280, 720 },
+	};
+	struct v4l2_subdev_format fmt = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.format = { .width = 1280, .height = 720 },
+	};
+
+	KUNIT_ASSERT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+			set_selection, &sel), 0);
+	KUNIT_EXPECT_EQ(test, sel.r.left, 320);
+	KUNIT_EXPECT_EQ(test, sel.r.top, 180);
+
+	KUNIT_ASSERT_EQ(test, v4l2_subdev_call_state_active(sd, pad, set_fmt,
+							    &fmt), 0);
+	KUNIT_EXPECT_EQ(test, fmt.format.width, 1280);
+	KUNIT_EXPECT_EQ(test, fmt.format.height, 720);
+
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(test->priv,
+						GC2607_REG_COL_START_H),
+			GC2607_COL_START + 320);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(test->priv,
+						GC2607_REG_ROW_START_H),
+			GC2607_ROW_START + 180);
+	KUNIT_EXPECT_EQ(test, gc2607_test_reg16(test->priv,
+						GC2607_REG_COL_COUNT_H), 1280);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(sd, 0), 0);
+}
+
+static void gc2607_test_set_fmt_busy(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	struct v4l2_subdev_selection sel = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.target = V4L2_SEL_TGT_CROP,
+		.r = { 320, 180, 1280, 720 },
+	};
+	struct v4l2_subdev_format fmt = {
+		.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		.format = { .width = 1920, .height = 1080 },
+	};
+
+	KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+	KUNIT_EXPECT_EQ(test, v4l2_subdev_call_state_active(sd, pad,
+			set_selection, &sel), -EBUSY);
+
+	/* Asking for the current size while streaming is fine */
+	KUNIT_EXPECT_EQ(test, v4l2_subdev_call_state_active(sd, pad, set_fmt,
+							    &fmt), 0);
+	KUNIT_EXPECT_EQ(test, gc2607_s_stream(sd, 0), 0);
+}
+
+/*
+ * gc2607_probe() error unwind: whatever fails, the sensor ends up powered
+ * off with runtime PM disabled, and a later probe still succeeds.
+ */
+static void gc2607_test_expect_unwound(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	KUNIT_EXPECT_NULL(test, bus->client->dev.driver);
+	KUNIT_EXPECT_EQ(test, bus->powered, 0);
+	KUNIT_EXPECT_FALSE(test, pm_runtime_enabled(&bus->client->dev));
+}
+
+static void gc2607_test_probe(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	KUNIT_ASSERT_NOT_NULL(test, gc2607_test_bind(test));
+	KUNIT_EXPECT_EQ(test, bus->powered, 1);
+
+	gc2607_test_unbind(test);
+	KUNIT_EXPECT_EQ(test, bus->powered, 0);
+}
+
+static void gc2607_test_probe_wrong_id(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	bus->regs[GC2607_REG_CHIP_ID_L] = 0x08;
+	KUNIT_EXPECT_NULL(test, gc2607_test_bind(test));
+	gc2607_test_expect_unwound(test);
+	KUNIT_EXPECT_EQ(test, bus->power_ons, 1);
+}
+
+static void gc2607_test_probe_power_fail(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+
+	bus->fail_power = true;
+	KUNIT_EXPECT_NULL(test, gc2607_test_bind(test));
+	gc2607_test_expect_unwound(test);
+	gc2607_test_unbind(test);
+
+	bus->fail_power = false;
+	KUNIT_EXPECT_NOT_NULL(test, gc2607_test_bind(test));
+}
+
+/* Fail every transfer from the n-th on, for each n a good probe reaches */
+static void gc2607_test_probe_i2c_fail(struct kunit *test)
+{
+	struct gc2607_test_bus *bus = test->priv;
+	unsigned int n, total;
+
+	KUNIT_ASSERT_NOT_NULL(test, gc2607_test_bind(test));
+	total = bus->xfers;
+	gc2607_test_unbind(test);
+
+	/* The two chip ID reads; nothing else touches the sensor at probe */
+	KUNIT_ASSERT_EQ(test, total, 2);
+
+	for (n = 0; n < total; n++) {
+		gc2607_test_clear_counts(bus);
+		bus->fail_from = n;
+		KUNIT_EXPECT_NULL(test, gc2607_test_bind(test));
+		gc2607_test_expect_unwound(test);
+		gc2607_test_unbind(test);
+	}
+
+	gc2607_test_clear_counts(bus);
+	bus->fail_from = -1;
+	KUNIT_EXPECT_NOT_NULL(test, gc2607_test_bind(test));
+	KUNIT_EXPECT_EQ(test, bus->xfers, total);
+}
+
+/*
+ * Microbenchmarks. The mock bus is free, so these time the driver's side:
+ * batching, regmap and control framework overhead per operation.
+ */
+#define GC2607_BENCH_RUNS		200
+
+static void gc2607_bench_report(struct kunit *test, const char *what,
+				ktime_t start, unsigned int runs)
+{
+	struct gc2607_test_bus *bus = test->priv;
+	s64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	kunit_info(test, "%s: %lld ns, %u transfers, %u messages, %u bytes per run\n",
+		   what, div_s64(ns, runs), bus->xfers / runs, bus->msgs / runs,
+		   bus->bytes / runs);
+	gc2607_test_clear_counts(bus);
+}
+
+static void gc2607_bench_tables(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	ktime_t start;
+	unsigned int i;
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++)
+		KUNIT_ASSERT_EQ(test, gc2607_write_segs(gc2607,
+						       gc2607_init_segs), 0);
+	gc2607_bench_report(test, "init segments", start, GC2607_BENCH_RUNS);
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++)
+		KUNIT_ASSERT_EQ(test, gc2607_write_segs(gc2607,
+						       gc2607_init_post_segs), 0);
+	gc2607_bench_report(test, "post-stream segments", start,
+			    GC2607_BENCH_RUNS);
+}
+
+static void gc2607_bench_ctrls(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	ktime_t start;
+	unsigned int i;
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++)
+		KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->exposure,
+							 100 + i), 0);
+	gc2607_bench_report(test, "exposure control", start, GC2607_BENCH_RUNS);
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++)
+		KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->gain,
+							 64 + i), 0);
+	gc2607_bench_report(test, "analogue gain control", start,
+			    GC2607_BENCH_RUNS);
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++)
+		KUNIT_ASSERT_EQ(test, v4l2_ctrl_s_ctrl(gc2607->vblank,
+							 1000 + i), 0);
+	gc2607_bench_report(test, "vblank control", start, GC2607_BENCH_RUNS);
+}
+
+static void gc2607_bench_stream(struct kunit *test)
+{
+	struct gc2607 *gc2607 = gc2607_test_bind_active(test);
+	struct v4l2_subdev *sd = &gc2607->sd;
+	ktime_t start;
+	unsigned int i;
+
+	/* Full initialization: init segments and control replay every time */
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++) {
+		gc2607->regs_valid = false;
+		KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+		KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 0), 0);
+	}
+	gc2607_bench_report(test, "stream on/off, full init", start,
+			    GC2607_BENCH_RUNS);
+
+	start = ktime_get();
+	for (i = 0; i < GC2607_BENCH_RUNS; i++) {
+		KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 1), 0);
+		KUNIT_ASSERT_EQ(test, gc2607_s_stream(sd, 0), 0);
+	}
+	gc2607_bench_report(test, "stream on/off, fast restart", start,
+			    GC2607_BENCH_RUNS);
+}
+
+static struct kunit_case gc2607_test_cases[] = {
+	KUNIT_CASE(gc2607_test_write_array_bursts),
+	KUNIT_CASE(gc2607_test_write_array_order),
+	KUNIT_CASE(gc2607_test_write_array_end),
+	KUNIT_CASE(gc2607_test_write_array_delay),
+	KUNIT_CASE(gc2607_test_write_array_split),
+	KUNIT_CASE(gc2607_test_write_array_error),
+	KUNIT_CASE(gc2607_test_init_segs),
+	KUNIT_CASE(gc2607_test_init_post_segs),
+	KUNIT_CASE_PARAM(gc2607_test_ctrl_gain, gc2607_test_gain_gen_params),
+	KUNIT_CASE(gc2607_test_ctrl_replay),
+	KUNIT_CASE(gc2607_test_enum_frame_size),
+	KUNIT_CASE_PARAM(gc2607_test_set_fmt, gc2607_test_fmt_gen_params),
+	KUNIT_CASE(gc2607_test_set_selection),
+	KUNIT_CASE(gc2607_test_set_fmt_busy),
+	KUNIT_CASE(gc2607_test_probe),
+	KUNIT_CASE(gc2607_test_probe_wrong_id),
+	KUNIT_CASE(gc2607_test_probe_power_fail),
+	KUNIT_CASE_SLOW(gc2607_test_probe_i2c_fail),
+	KUNIT_CASE_SLOW(gc2607_bench_tables),
+	KUNIT_CASE_SLOW(gc2607_bench_ctrls),
+	KUNIT_CASE_SLOW(gc2607_bench_stream),
+	{}
+};
+
+static struct kunit_suite gc2607_test_suite = {
+	.name = "gc2607",
+	.init = gc2607_test_init,
+	.exit = gc2607_test_exit,
+	.suite_init = gc2607_test_suite_init,
+	.suite_exit = gc2607_test_suite_exit,
+	.test_cases = gc2607_test_cases,
+};
+
+kunit_test_suite(gc2607_test_suite);
@@ -0,0 +1,52 @@
+#!/bin/bash
+# Run the KUnit suite with kunit.py in a kernel source tree
+#
+# kunit.py only builds in-tree code, so the driver is linked into
+# drivers/media/i2c/gc2607 of that tree for the run. The directory and the
+# two lines this adds to drivers/media/i2c/{Kconfig,Makefile} are removed
+# again on exit.
+#
+# Usage: KSRC=~/src/linux tests/run_kunit.sh [kunit.py run options]
+
+set -e
+
+REPO=$(cd "$(dirname "$0")/.." && pwd)
+KSRC=${KSRC:-$REPO/../linux}
+
+if [ ! -x "$KSRC/tools/testing/kunit/kunit.py" ]; then
+    echo "Error: no kernel source tree at $KSRC (set KSRC)"
+    exit 1
+fi
+
+I2C=$KSRC/drivers/media/i2c
+DIR=$I2C/gc2607
+KCONFIG_LINE='source "drivers/media/i2c/gc2607/Kconfig"'
+MAKEFILE_LINE='obj-y += gc2607/'
+
+if [ -e "$DIR" ]; then
+    echo "Error: $DIR already exists"
+    exit 1
+fi
+
+cleanup() {
+    grep -vxF "$KCONFIG_LINE" "$I2C/Kconfig" > "$I2C/Kconfig.gc2607" &&
+        mv "$I2C/Kconfig.gc2607" "$I2C/Kconfig"
+    grep -vxF "$MAKEFILE_LINE" "$I2C/Makefile" > "$I2C/Makefile.gc2607" &&
+        mv "$I2C/Makefile.gc2607" "$I2C/Makefile"
+    rm -rf "$DIR"
+}
+trap cleanup EXIT
+
+mkdir -p "$DIR/tests"
+ln -sf "$REPO/gc2607.c" "$REPO/gc2607_trace.h" "$REPO/Kbuild" "$DIR/"
+ln -sf "$REPO/gc2607_init.regs" "$REPO/compile_regs.py" "$DIR/"
+ln -sf "$REPO/tests/Kconfig" "$REPO/tests/.kunitconfig" "$DIR/"
+ln -sf "$REPO/tests/gc2607_kunit.c" "$DIR/tests/"
+
+echo "$KCONFIG_LINE" >> "$I2C/Kconfig"
+echo "$MAKEFILE_LINE" >> "$I2C/Makefile"
+
+# The media core needs HAS_IOMEM, which UML lacks; run on x86_64 under QEMU
+cd "$KSRC"
+./tools/testing/kunit/kunit.py run \
+    --kunitconfig=drivers/media/i2c/gc2607 --arch=x86_64 "$@"
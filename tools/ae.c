@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Auto-exposure controller
+ *
+ * Each frame the measured green level is compared with the target, in
+ * the log domain. The exposure x gain that would hit the target is
+ * computed from the settings in effect for that frame, and the request is
+ * moved a share (speed) of the way there. The total is then split into
+ * exposure first, up to the frame length, and analogue gain only for what
+ * exposure cannot provide.
+ *
+ * A deadband with hysteresis stops the loop from chasing noise once it
+ * has converged: adjusting starts when the error leaves the tolerance and
+ * stops only when it is back inside half of it.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "ae.h"
+
+#define AE_QUEUE	8	/* Writes in flight; more than any apply delay */
+#define AE_MAX_STEP	8.0	/* Largest correction in one frame */
+#define AE_CLIP_STEP	0.7	/* Correction while too much is clipped */
+
+struct ae_write {
+	unsigned int seq;	/* First frame the write applies to */
+	struct ae_setting setting;
+};
+
+struct ae {
+	struct ae_params p;
+	struct ae_setting current;	/* In effect for the frame being processed */
+	struct ae_setting requested;	/* Last write */
+	struct ae_write queue[AE_QUEUE];
+	unsigned int head, count;
+	bool adjusting;
+};
+
+double ae_total(const struct ae *ae, const struct ae_setting *s)
+{
+	return (double)s->exposure * s->gain / ae->p.gain_unit;
+}
+
+/* Split @total into exposure first, then the smallest gain that reaches it */
+static struct ae_setting ae_allocate(const struct ae *ae, double total)
+{
+	const struct ae_params *p = &ae->p;
+	struct ae_setting s = {
+		.exposure = p->exposure_max,
+		.gain = p->gain_min,
+	};
+	double gain, exposure;
+
+	gain = ceil(total * p->gain_unit / p->exposure_max);
+	if (gain > p->gain_max)
+		gain = p->gain_max;
+	if (gain > s.gain)
+		s.gain = gain;
+
+	/* Trim the exposure for what the rounded-up gain overshoots */
+	exposure = total * p->gain_unit / s.gain + 0.5;
+	if (exposure < p->exposure_min)
+		exposure = p->exposure_min;
+	if (exposure < p->exposure_max)
+		s.exposure = exposure;
+
+	return s;
+}
+
+struct ae *ae_create(const struct ae_params *params,
+		     const struct ae_setting *initial)
+{
+	struct ae *ae;
+
+	if (!params->gain_unit || params->gain_min > params->gain_max ||
+	    params->exposure_min > params->exposure_max ||
+	    params->target <= 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ae = calloc(1, sizeof(*ae));
+	if (!ae)
+		return NULL;
+
+	ae->p = *params;
+	if (ae->p.speed <= 0 || ae->p.speed > 1)
+		ae->p.speed = 1;
+	ae->current = *initial;
+	ae->requested = *initial;
+
+	return ae;
+}
+
+void ae_destroy(struct ae *ae)
+{
+	free(ae);
+}
+
+/* Retire the writes that have reached frame @seq */
+static void ae_advance(struct ae *ae, unsigned int seq)
+{
+	while (ae->count) {
+		struct ae_write *w = &ae->queue[ae->head];
+
+		if ((int)(seq - w->seq) < 0)
+			break;
+
+		ae->current = w->setting;
+		ae->head = (ae->head + 1) % AE_QUEUE;
+		ae->count--;
+	}
+}
+
+bool ae_process(struct ae *ae, unsigned int seq, const struct stats *st,
+		struct ae_setting *next, struct ae_status *status)
+{
+	const struct ae_params *p = &ae->p;
+	double green, level, clipped, error, band, total, desired, requested;
+	double min_total, max_total;
+	struct ae_setting s;
+
+	ae_advance(ae, seq);
+
+	green = (stats_mean(st, STATS_GR) + stats_mean(st, STATS_GB)) / 2;
+	level = green > p->black_level + 1 ? green - p->black_level : 1;
+	clipped = st->quads ? (st->hist[STATS_GR][STATS_BINS - 1] +
+			       st->hist[STATS_GB][STATS_BINS - 1]) /
+			      (2.0 * st->quads) : 0;
+	total = ae_total(ae, &ae->current);
+
+	status->level = level;
+	status->total = total;
+
+	error = log(p->target / level);
+	band = log(1 + (ae->adjusting ? p->tolerance / 2 : p->tolerance));
+	if (clipped > p->clip_limit && error > log(AE_CLIP_STEP))
+		error = log(AE_CLIP_STEP);
+
+	status->converged = fabs(error) < band;
+	if (status->converged) {
+		ae->adjusting = false;
+		return false;
+	}
+	ae->adjusting = true;
+
+	if (error > log(AE_MAX_STEP))
+		error = log(AE_MAX_STEP);
+	else if (error < -log(AE_MAX_STEP))
+		error = -log(AE_MAX_STEP);
+
+	min_total = (double)p->exposure_min * p->gain_min / p->gain_unit;
+	max_total = (double)p->exposure_max * p->gain_max / p->gain_unit;
+	desired = fmin(fmax(total * exp(error), min_total), max_total);
+
+	/* Move the request, not the frame's settings, toward the target */
+	requested = ae_total(ae, &ae->requested);
+	s = ae_allocate(ae, requested * pow(desired / requested, p->speed));
+
+	if (s.exposure == ae->requested.exposure &&
+	    s.gain == ae->requested.gain)
+		return false;
+
+	if (ae->count == AE_QUEUE) {
+		/* Frames are not arriving as fast as writes; drop the oldest */
+		ae->current = ae->queue[ae->head].setting;
+		ae->head = (ae->head + 1) % AE_QUEUE;
+		ae->count--;
+	}
+	ae->queue[(ae->head + ae->count) % AE_QUEUE] = (struct ae_write) {
+		.seq = seq + p->delay,
+		.setting = s,
+	};
+	ae->count++;
+	ae->requested = s;
+
+	*next = s;
+	return true;
+}
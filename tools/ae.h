@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Auto-exposure controller
+ *
+ * Turns per-frame statistics into exposure (lines) and analogue gain
+ * settings, the gain as a linear control code. The controller is
+ * independent of V4L2 so the same code runs on a live sensor and on a
+ * replayed capture.
+ *
+ * Sensor writes land @delay frames after they are made. The statistics of
+ * a frame are therefore always compared against the settings that were
+ * in effect for that frame, and the correction is computed as an
+ * absolute target rather than relative to the last request. That keeps
+ * the loop from correcting the same error again while a write is still
+ * in flight.
+ */
+#ifndef GC2607_AE_H
+#define GC2607_AE_H
+
+#include <stdbool.h>
+
+#include "stats.h"
+
+struct ae_params {
+	double target;			/* Mean green level, 10-bit above black */
+	unsigned int black_level;
+	unsigned int exposure_min;	/* Lines */
+	unsigned int exposure_max;
+	unsigned int gain_min;		/* Control values, linear */
+	unsigned int gain_max;
+	unsigned int gain_unit;		/* Control value of 1.0x */
+	unsigned int delay;		/* Frames until a write takes effect */
+	double speed;			/* Share of the error corrected per frame */
+	double tolerance;		/* Relative deadband around the target */
+	double clip_limit;		/* Share of green samples allowed to clip */
+};
+
+struct ae_setting {
+	unsigned int exposure;
+	unsigned int gain;		/* Control value */
+};
+
+struct ae_status {
+	double level;			/* Measured mean green above black */
+	double total;			/* Exposure x gain in effect, in lines */
+	bool converged;
+};
+
+struct ae;
+
+struct ae *ae_create(const struct ae_params *params,
+		     const struct ae_setting *initial);
+void ae_destroy(struct ae *ae);
+
+/*
+ * Feed the statistics of frame @seq. Returns true when @next should be
+ * written to the sensor now.
+ */
+bool ae_process(struct ae *ae, unsigned int seq, const struct stats *st,
+		struct ae_setting *next, struct ae_status *status);
+
+/* Exposure x gain of a setting, in lines */
+double ae_total(const struct ae *ae, const struct ae_setting *s);
+
+#endif /* GC2607_AE_H */
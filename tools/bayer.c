@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Bayer orders of the GC2607 readout
+ */
+
+#include <errno.h>
+#include <strings.h>
+
+#include "bayer.h"
+
+static const char *const bayer_names[] = {
+	[BAYER_GRBG] = "grbg",
+	[BAYER_RGGB] = "rggb",
+	[BAYER_BGGR] = "bggr",
+	[BAYER_GBRG] = "gbrg",
+};
+
+int bayer_parse(const char *name, enum bayer_order *order)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(bayer_names) / sizeof(bayer_names[0]); i++) {
+		if (!strcasecmp(name, bayer_names[i])) {
+			*order = i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+const char *bayer_name(enum bayer_order order)
+{
+	return bayer_names[order & 3];
+}
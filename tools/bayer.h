@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Bayer orders of the GC2607 readout
+ *
+ * The sensor reads out GRBG. Mirroring or flipping the readout starts it
+ * one column or one row further into the pattern, so every order is GRBG
+ * shifted by (dx, dy): raw pixel (x, y) has the colour GRBG has at
+ * (x + dx, y + dy). The order is encoded as dy * 2 + dx, which makes the
+ * GRBG channel of raw quad position (x & 1) + 2 * (y & 1) that position
+ * XOR the order.
+ */
+#ifndef GC2607_BAYER_H
+#define GC2607_BAYER_H
+
+enum bayer_order {
+	BAYER_GRBG = 0,
+	BAYER_RGGB = 1,		/* Mirrored */
+	BAYER_BGGR = 2,		/* Flipped */
+	BAYER_GBRG = 3,		/* Mirrored and flipped */
+};
+
+#define BAYER_DX(order)		((order) & 1)
+#define BAYER_DY(order)		((order) >> 1)
+
+int bayer_parse(const char *name, enum bayer_order *order);
+const char *bayer_name(enum bayer_order order);
+
+#endif /* GC2607_BAYER_H */
@@ -0,0 +1,326 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * GRBG10 to YUV converter for the GC2607
+ *
+ * Other Bayer orders are read as GRBG shifted by a pixel: the row and
+ * column pointers handed to the demosaic are offset by the order's phase,
+ * which costs nothing per pixel and moves the image by at most one pixel.
+ *
+ * Frames are processed one raw row pair at a time. Each raw row is
+ * unpacked once into a ring of four row slots (the pair plus one row of
+ * context above and below), demosaiced into per-quad YUV and written to
+ * its final place in the output, rotated if asked for. The working set is
+ * a few kilobytes per row, so a frame is a single pass over memory.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "convert.h"
+#include "convert_kernels.h"
+
+#define CONVERT_SLOTS	4
+
+struct convert {
+	struct convert_params p;
+	const struct convert_kernels *k;
+	unsigned int half;
+	size_t stride;
+	int gain[2][2];			/* [row parity][column parity], Q8 */
+
+	/* Row slots; each plane has one element of padding on either side */
+	int16_t *planes;
+	int16_t *even[CONVERT_SLOTS];
+	int16_t *odd[CONVERT_SLOTS];
+	int slot_row[CONVERT_SLOTS];
+
+	uint8_t *quad_buf;
+	struct convert_quads quads;
+};
+
+static const struct convert_kernels *const convert_all_kernels[] = {
+#ifdef CONVERT_HAVE_X86
+	&convert_kernels_avx2,
+	&convert_kernels_sse41,
+#endif
+	&convert_kernels_scalar,
+};
+
+#define CONVERT_NUM_KERNELS \
+	(sizeof(convert_all_kernels) / sizeof(convert_all_kernels[0]))
+
+static bool kernel_supported(const struct convert_kernels *k)
+{
+#ifdef CONVERT_HAVE_X86
+	__builtin_cpu_init();
+	if (k == &convert_kernels_avx2)
+		return __builtin_cpu_supports("avx2");
+	if (k == &convert_kernels_sse41)
+		return __builtin_cpu_supports("sse4.1");
+#endif
+	return true;
+}
+
+const char *const *convert_kernels(void)
+{
+	static const char *names[CONVERT_NUM_KERNELS + 1];
+	unsigned int i, n = 0;
+
+	if (names[0])
+		return names;
+
+	for (i = 0; i < CONVERT_NUM_KERNELS; i++)
+		if (kernel_supported(convert_all_kernels[i]))
+			names[n++] = convert_all_kernels[i]->name;
+	names[n] = NULL;
+
+	return names;
+}
+
+static const struct convert_kernels *find_kernels(const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < CONVERT_NUM_KERNELS; i++) {
+		const struct convert_kernels *k = convert_all_kernels[i];
+
+		if (!kernel_supported(k))
+			continue;
+		if (!name || !strcmp(name, k->name))
+			return k;
+	}
+
+	return NULL;
+}
+
+int convert_parse_format(const char *name, enum convert_format *format)
+{
+	if (!strcmp(name, "i420"))
+		*format = CONVERT_I420;
+	else if (!strcmp(name, "nv12"))
+		*format = CONVERT_NV12;
+	else if (!strcmp(name, "yuy2"))
+		*format = CONVERT_YUY2;
+	else
+		return -EINVAL;
+
+	return 0;
+}
+
+static size_t convert_stride(const struct convert_params *p)
+{
+	if (p->stride)
+		return p->stride;
+
+	return p->packed ? p->width / 4 * 5 : p->width * 2;
+}
+
+size_t convert_input_size(const struct convert_params *p)
+{
+	return convert_stride(p) * p->height;
+}
+
+size_t convert_output_size(const struct convert_params *p)
+{
+	size_t pixels = (size_t)p->width * p->height;
+
+	return p->format == CONVERT_YUY2 ? pixels * 2 : pixels * 3 / 2;
+}
+
+const char *convert_kernel_name(const struct convert *conv)
+{
+	return conv->k->name;
+}
+
+/*
+ * Q8 gain of a channel, including the stretch that maps the range left
+ * above the black level back to the full 10 bits.
+ */
+static int channel_gain(const struct convert_params *p, float wb)
+{
+	float range = CONVERT_MAX - p->black_level;
+
+	return wb * CONVERT_MAX / range * (1 << CONVERT_GAIN_SHIFT) + 0.5f;
+}
+
+struct convert *convert_create(const struct convert_params *params)
+{
+	struct convert *conv;
+	size_t plane_len;
+	unsigned int i;
+
+	if (!params->width || !params->height || params->width % 4 ||
+	    params->height % 2 || params->black_level >= CONVERT_MAX) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	conv = calloc(1, sizeof(*conv));
+	if (!conv)
+		return NULL;
+
+	conv->p = *params;
+	conv->half = params->width / 2;
+	conv->stride = convert_stride(params);
+
+	conv->k = find_kernels(params->kernel);
+	if (!conv->k) {
+		errno = ENOTSUP;
+		goto err;
+	}
+
+	/* Gains follow the colour of the raw pixel, GRBG shifted by the order */
+	for (i = 0; i < 4; i++) {
+		static const int grbg[4] = { 1, 0, 2, 1 };	/* G R B G */
+		const float wb[3] = { params->wb_r, params->wb_g,
+				      params->wb_b };
+
+		conv->gain[i >> 1][i & 1] =
+			channel_gain(params, wb[grbg[i ^ params->bayer]]);
+	}
+
+	plane_len = conv->half + 2;
+	conv->planes = calloc(CONVERT_SLOTS * 2, plane_len * sizeof(int16_t));
+	conv->quad_buf = malloc(8 * conv->half);
+	if (!conv->planes || !conv->quad_buf)
+		goto err;
+
+	for (i = 0; i < CONVERT_SLOTS; i++) {
+		conv->even[i] = conv->planes + (2 * i) * plane_len + 1;
+		conv->odd[i] = conv->planes + (2 * i + 1) * plane_len + 1;
+	}
+
+	conv->quads.y00 = conv->quad_buf;
+	conv->quads.y01 = conv->quad_buf + 1 * conv->half;
+	conv->quads.y10 = conv->quad_buf + 2 * conv->half;
+	conv->quads.y11 = conv->quad_buf + 3 * conv->half;
+	conv->quads.u0 = conv->quad_buf + 4 * conv->half;
+	conv->quads.v0 = conv->quad_buf + 5 * conv->half;
+	conv->quads.u1 = conv->quad_buf + 6 * conv->half;
+	conv->quads.v1 = conv->quad_buf + 7 * conv->half;
+
+	return conv;
+
+err:
+	convert_destroy(conv);
+	return NULL;
+}
+
+void convert_destroy(struct convert *conv)
+{
+	if (!conv)
+		return;
+
+	free(conv->planes);
+	free(conv->quad_buf);
+	free(conv);
+}
+
+/*
+ * Slot holding raw row @row, unpacking it if needed. Rows outside the
+ * frame mirror onto the nearest row of the same colour.
+ */
+static unsigned int load_row(struct convert *conv, const uint8_t *raw, int row)
+{
+	int height = conv->p.height;
+	int parity, gain_even, gain_odd;
+	unsigned int slot;
+	const uint8_t *src;
+
+	if (row < 0)
+		row = -row;
+	else if (row >= height)
+		row = 2 * (height - 1) - row;
+
+	slot = row % CONVERT_SLOTS;
+	if (conv->slot_row[slot] == row)
+		return slot;
+
+	parity = row & 1;
+	gain_even = conv->gain[parity][0];
+	gain_odd = conv->gain[parity][1];
+	src = raw + (size_t)row * conv->stride;
+
+	if (conv->p.packed)
+		conv->k->unpack10p(src, conv->half, conv->p.black_level,
+				   gain_even, gain_odd, conv->even[slot],
+				   conv->odd[slot]);
+	else
+		conv->k->unpack16((const uint16_t *)src, conv->half,
+				  conv->p.black_level, gain_even, gain_odd,
+				  conv->even[slot], conv->odd[slot]);
+
+	/*
+	 * Mirror the first and last columns into the padding, on both sides
+	 * of both planes since a column shift swaps their roles.
+	 */
+	conv->even[slot][-1] = conv->even[slot][conv->half > 1 ? 1 : 0];
+	conv->odd[slot][-1] = conv->odd[slot][0];
+	conv->even[slot][conv->half] = conv->even[slot][conv->half - 1];
+	conv->odd[slot][conv->half] = conv->odd[slot][conv->half > 1 ?
+						       conv->half - 2 : 0];
+
+	conv->slot_row[slot] = row;
+	return slot;
+}
+
+void convert_frame(struct convert *conv, const void *raw, void *out)
+{
+	const struct convert_params *p = &conv->p;
+	unsigned int width = p->width, height = p->height;
+	uint8_t *luma = out;
+	uint8_t *cb = luma + (size_t)width * height;
+	uint8_t *cr = cb + (size_t)width * height / 4;
+	int16_t *even[CONVERT_SLOTS], *odd[CONVERT_SLOTS];
+	unsigned int i;
+
+	/*
+	 * GRBG column 2k + dx is raw column 2k: with a column phase the GRBG
+	 * even plane starts one element before the raw odd plane.
+	 */
+	for (i = 0; i < CONVERT_SLOTS; i++) {
+		conv->slot_row[i] = -1;
+		even[i] = BAYER_DX(p->bayer) ? conv->odd[i] - 1 : conv->even[i];
+		odd[i] = BAYER_DX(p->bayer) ? conv->even[i] : conv->odd[i];
+	}
+
+	for (i = 0; i < height / 2; i++) {
+		int row = 2 * i - BAYER_DY(p->bayer);
+		unsigned int a = load_row(conv, raw, row - 1);
+		unsigned int b = load_row(conv, raw, row);
+		unsigned int c = load_row(conv, raw, row + 1);
+		unsigned int d = load_row(conv, raw, row + 2);
+		unsigned int out_pair = p->rotate180 ? height / 2 - 1 - i : i;
+		unsigned int top = 2 * out_pair + (p->rotate180 ? 1 : 0);
+		unsigned int bottom = 2 * out_pair + (p->rotate180 ? 0 : 1);
+
+		conv->k->demosaic(even[a], odd[a], even[b], odd[b],
+				  even[c], odd[c], even[d], odd[d],
+				  conv->half, &conv->quads);
+
+		switch (p->format) {
+		case CONVERT_I420:
+			conv->k->pack_planar(&conv->quads, conv->half,
+					     p->rotate180,
+					     luma + (size_t)top * width,
+					     luma + (size_t)bottom * width,
+					     cb + (size_t)out_pair * width / 2,
+					     cr + (size_t)out_pair * width / 2);
+			break;
+		case CONVERT_NV12:
+			conv->k->pack_nv12(&conv->quads, conv->half,
+					   p->rotate180,
+					   luma + (size_t)top * width,
+					   luma + (size_t)bottom * width,
+					   cb + (size_t)out_pair * width);
+			break;
+		case CONVERT_YUY2:
+			conv->k->pack_yuy2(&conv->quads, conv->half,
+					   p->rotate180,
+					   luma + (size_t)top * width * 2,
+					   luma + (size_t)bottom * width * 2);
+			break;
+		}
+	}
+}
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Bayer RAW10 to YUV converter for the GC2607
+ *
+ * One pass per row pair: unpack, black level, white balance, bilinear
+ * demosaic, optional 180 degree rotation and YUV output, all in line
+ * buffers that stay in L1. The row kernels are built for AVX2, SSE4.1
+ * and plain C and picked at runtime.
+ */
+#ifndef GC2607_CONVERT_H
+#define GC2607_CONVERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bayer.h"
+
+enum convert_format {
+	CONVERT_I420,
+	CONVERT_NV12,
+	CONVERT_YUY2,
+};
+
+struct convert_params {
+	unsigned int width;		/* Even, in pixels */
+	unsigned int height;		/* Even, in lines */
+	size_t stride;			/* Bytes per raw line, 0 = no padding */
+	bool packed;			/* CSI-2 packed RAW10, else 16-bit LE */
+	enum bayer_order bayer;		/* GRBG unless the readout is flipped */
+	enum convert_format format;
+	unsigned int black_level;	/* In 10-bit units */
+	float wb_r, wb_g, wb_b;		/* White balance gains */
+	bool rotate180;			/* The sensor is mounted upside down */
+	const char *kernel;		/* NULL picks the best available */
+};
+
+struct convert;
+
+struct convert *convert_create(const struct convert_params *params);
+void convert_destroy(struct convert *conv);
+
+/* Convert one frame; @out must hold convert_output_size() bytes */
+void convert_frame(struct convert *conv, const void *raw, void *out);
+
+size_t convert_input_size(const struct convert_params *params);
+size_t convert_output_size(const struct convert_params *params);
+const char *convert_kernel_name(const struct convert *conv);
+
+/* NULL-terminated list of the kernels this CPU can run, best first */
+const char *const *convert_kernels(void);
+
+int convert_parse_format(const char *name, enum convert_format *format);
+
+#endif /* GC2607_CONVERT_H */
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Row kernels of the GRBG10 converter, built once per instruction set
+ *
+ * Every loop runs over contiguous half-width planes with no cross-lane
+ * dependencies, so the compiler vectorises it for the -m flags of the
+ * object being built; the scalar build disables vectorisation. The row
+ * buffers never overlap, which the ivdep pragmas tell the compiler so it
+ * does not give up on runtime alias checks. Rotated rows are written in
+ * output order and read backwards, which vectorises as a byte shuffle.
+ */
+
+#include "convert_kernels.h"
+
+#if !defined(CONVERT_KERNEL_SUFFIX) || !defined(CONVERT_KERNEL_NAME)
+#error "CONVERT_KERNEL_SUFFIX and CONVERT_KERNEL_NAME must be set by the build"
+#endif
+
+#define CONCAT_(a, b)	a##b
+#define CONCAT(a, b)	CONCAT_(a, b)
+#define KFN(name)	CONCAT(name##_, CONVERT_KERNEL_SUFFIX)
+
+static inline int16_t scale(int v, int black, int gain)
+{
+	v = ((v & CONVERT_MAX) - black) * gain >> CONVERT_GAIN_SHIFT;
+	return v < 0 ? 0 : v > CONVERT_MAX ? CONVERT_MAX : v;
+}
+
+static inline uint8_t clamp8(int v)
+{
+	return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+/* BT.601 limited range from 10-bit RGB */
+static inline uint8_t rgb_to_y(int r, int g, int b)
+{
+	return ((66 * r + 129 * g + 25 * b + 512) >> 10) + 16;
+}
+
+/* Chroma from the sums of two 10-bit RGB pixels */
+static inline uint8_t rgb2_to_u(int r, int g, int b)
+{
+	return clamp8(((-38 * r - 74 * g + 112 * b + 1024) >> 11) + 128);
+}
+
+static inline uint8_t rgb2_to_v(int r, int g, int b)
+{
+	return clamp8(((112 * r - 94 * g - 18 * b + 1024) >> 11) + 128);
+}
+
+static void KFN(unpack16)(const uint16_t *restrict src, unsigned int half,
+			  int black, int gain_even, int gain_odd,
+			  int16_t *restrict even, int16_t *restrict odd)
+{
+	size_t i;
+
+#pragma GCC ivdep
+	for (i = 0; i < half; i++) {
+		even[i] = scale(src[2 * i], black, gain_even);
+		odd[i] = scale(src[2 * i + 1], black, gain_odd);
+	}
+}
+
+/* CSI-2 RAW10: four 8-bit MSB bytes, then one byte of 2-bit LSBs */
+static void KFN(unpack10p)(const uint8_t *restrict src, unsigned int half,
+			   int black, int gain_even, int gain_odd,
+			   int16_t *restrict even, int16_t *restrict odd)
+{
+	size_t i;
+
+#pragma GCC ivdep
+	for (i = 0; i < half; i += 2, src += 5) {
+		int lsb = src[4];
+
+		even[i] = scale(src[0] << 2 | (lsb & 3), black, gain_even);
+		odd[i] = scale(src[1] << 2 | (lsb >> 2 & 3), black, gain_odd);
+		even[i + 1] = scale(src[2] << 2 | (lsb >> 4 & 3), black,
+				    gain_even);
+		odd[i + 1] = scale(src[3] << 2 | (lsb >> 6), black, gain_odd);
+	}
+}
+
+/*
+ * Bilinear demosaic of one row pair. For quad i, with b/c the current
+ * even/odd rows and a/d the rows above and below:
+ *
+ *   (2i, b)    G  R = avg(Ob[i-1], Ob[i])            B = avg(Ea[i], Ec[i])
+ *   (2i+1, b)  R  G = avg(Eb[i], Eb[i+1], Oa[i], Oc[i])
+ *                 B = avg(Ea[i], Ea[i+1], Ec[i], Ec[i+1])
+ *   (2i, c)    B  G = avg(Oc[i-1], Oc[i], Eb[i], Ed[i])
+ *                 R = avg(Ob[i-1], Ob[i], Od[i-1], Od[i])
+ *   (2i+1, c)  G  R = avg(Ob[i], Od[i])              B = avg(Ec[i], Ec[i+1])
+ */
+static void KFN(demosaic)(const int16_t *restrict ea, const int16_t *restrict oa,
+			  const int16_t *restrict eb, const int16_t *restrict ob,
+			  const int16_t *restrict ec, const int16_t *restrict oc,
+			  const int16_t *restrict ed, const int16_t *restrict od,
+			  unsigned int half, const struct convert_quads *q)
+{
+	uint8_t *restrict y00 = q->y00, *restrict y01 = q->y01;
+	uint8_t *restrict y10 = q->y10, *restrict y11 = q->y11;
+	uint8_t *restrict u0 = q->u0, *restrict v0 = q->v0;
+	uint8_t *restrict u1 = q->u1, *restrict v1 = q->v1;
+	/* Left neighbours of the odd planes, right neighbours of the even */
+	const int16_t *restrict obl = ob - 1, *restrict ocl = oc - 1;
+	const int16_t *restrict odl = od - 1, *restrict ear = ea + 1;
+	const int16_t *restrict ebr = eb + 1, *restrict ecr = ec + 1;
+	size_t i;
+
+#pragma GCC ivdep
+	for (i = 0; i < half; i++) {
+		int g00 = eb[i];
+		int r00 = (obl[i] + ob[i] + 1) >> 1;
+		int b00 = (ea[i] + ec[i] + 1) >> 1;
+
+		int r01 = ob[i];
+		int g01 = (eb[i] + ebr[i] + oa[i] + oc[i] + 2) >> 2;
+		int b01 = (ea[i] + ear[i] + ec[i] + ecr[i] + 2) >> 2;
+
+		int b10 = ec[i];
+		int g10 = (ocl[i] + oc[i] + eb[i] + ed[i] + 2) >> 2;
+		int r10 = (obl[i] + ob[i] + odl[i] + od[i] + 2) >> 2;
+
+		int g11 = oc[i];
+		int r11 = (ob[i] + od[i] + 1) >> 1;
+		int b11 = (ec[i] + ecr[i] + 1) >> 1;
+
+		y00[i] = rgb_to_y(r00, g00, b00);
+		y01[i] = rgb_to_y(r01, g01, b01);
+		y10[i] = rgb_to_y(r10, g10, b10);
+		y11[i] = rgb_to_y(r11, g11, b11);
+		u0[i] = rgb2_to_u(r00 + r01, g00 + g01, b00 + b01);
+		v0[i] = rgb2_to_v(r00 + r01, g00 + g01, b00 + b01);
+		u1[i] = rgb2_to_u(r10 + r11, g10 + g11, b10 + b11);
+		v1[i] = rgb2_to_v(r10 + r11, g10 + g11, b10 + b11);
+	}
+}
+
+/*
+ * With rotation, quad i lands at quad half - 1 - i of the output row and
+ * its two columns swap; the caller has already swapped the rows.
+ */
+static void KFN(pack_planar)(const struct convert_quads *q, unsigned int half,
+			     bool rotate, uint8_t *y0, uint8_t *y1,
+			     uint8_t *u, uint8_t *v)
+{
+	const uint8_t *restrict y00 = q->y00, *restrict y01 = q->y01;
+	const uint8_t *restrict y10 = q->y10, *restrict y11 = q->y11;
+	const uint8_t *restrict u0 = q->u0, *restrict v0 = q->v0;
+	const uint8_t *restrict u1 = q->u1, *restrict v1 = q->v1;
+	size_t i, j;
+
+	if (rotate) {
+#pragma GCC ivdep
+		for (j = 0; j < half; j++) {
+			i = half - 1 - j;
+			y0[2 * j] = y01[i];
+			y0[2 * j + 1] = y00[i];
+			y1[2 * j] = y11[i];
+			y1[2 * j + 1] = y10[i];
+			u[j] = (u0[i] + u1[i] + 1) >> 1;
+			v[j] = (v0[i] + v1[i] + 1) >> 1;
+		}
+	} else {
+#pragma GCC ivdep
+		for (i = 0; i < half; i++) {
+			y0[2 * i] = y00[i];
+			y0[2 * i + 1] = y01[i];
+			y1[2 * i] = y10[i];
+			y1[2 * i + 1] = y11[i];
+			u[i] = (u0[i] + u1[i] + 1) >> 1;
+			v[i] = (v0[i] + v1[i] + 1) >> 1;
+		}
+	}
+}
+
+static void KFN(pack_nv12)(const struct convert_quads *q, unsigned int half,
+			   bool rotate, uint8_t *restrict y0,
+				   uint8_t *restrict y1, uint8_t *restrict uv)
+{
+	const uint8_t *restrict y00 = q->y00, *restrict y01 = q->y01;
+	const uint8_t *restrict y10 = q->y10, *restrict y11 = q->y11;
+	const uint8_t *restrict u0 = q->u0, *restrict v0 = q->v0;
+	const uint8_t *restrict u1 = q->u1, *restrict v1 = q->v1;
+	size_t i, j;
+
+	if (rotate) {
+#pragma GCC ivdep
+		for (j = 0; j < half; j++) {
+			i = half - 1 - j;
+			y0[2 * j] = y01[i];
+			y0[2 * j + 1] = y00[i];
+			y1[2 * j] = y11[i];
+			y1[2 * j + 1] = y10[i];
+			uv[2 * j] = (u0[i] + u1[i] + 1) >> 1;
+			uv[2 * j + 1] = (v0[i] + v1[i] + 1) >> 1;
+		}
+	} else {
+#pragma GCC ivdep
+		for (i = 0; i < half; i++) {
+			y0[2 * i] = y00[i];
+			y0[2 * i + 1] = y01[i];
+			y1[2 * i] = y10[i];
+			y1[2 * i + 1] = y11[i];
+			uv[2 * i] = (u0[i] + u1[i] + 1) >> 1;
+			uv[2 * i + 1] = (v0[i] + v1[i] + 1) >> 1;
+		}
+	}
+}
+
+/* YUY2 is 4:2:2, so each row keeps the chroma of its own pixel pair */
+static void KFN(pack_yuy2)(const struct convert_quads *q, unsigned int half,
+			   bool rotate, uint8_t *restrict y0,
+				   uint8_t *restrict y1)
+{
+	const uint8_t *restrict y00 = q->y00, *restrict y01 = q->y01;
+	const uint8_t *restrict y10 = q->y10, *restrict y11 = q->y11;
+	const uint8_t *restrict u0 = q->u0, *restrict v0 = q->v0;
+	const uint8_t *restrict u1 = q->u1, *restrict v1 = q->v1;
+	size_t i, j;
+
+	if (rotate) {
+#pragma GCC ivdep
+		for (j = 0; j < half; j++) {
+			i = half - 1 - j;
+			y0[4 * j] = y01[i];
+			y0[4 * j + 1] = u0[i];
+			y0[4 * j + 2] = y00[i];
+			y0[4 * j + 3] = v0[i];
+			y1[4 * j] = y11[i];
+			y1[4 * j + 1] = u1[i];
+			y1[4 * j + 2] = y10[i];
+			y1[4 * j + 3] = v1[i];
+		}
+	} else {
+#pragma GCC ivdep
+		for (i = 0; i < half; i++) {
+			y0[4 * i] = y00[i];
+			y0[4 * i + 1] = u0[i];
+			y0[4 * i + 2] = y01[i];
+			y0[4 * i + 3] = v0[i];
+			y1[4 * i] = y10[i];
+			y1[4 * i + 1] = u1[i];
+			y1[4 * i + 2] = y11[i];
+			y1[4 * i + 3] = v1[i];
+		}
+	}
+}
+
+const struct convert_kernels CONCAT(convert_kernels_, CONVERT_KERNEL_SUFFIX) = {
+	.name = CONVERT_KERNEL_NAME,
+	.unpack16 = KFN(unpack16),
+	.unpack10p = KFN(unpack10p),
+	.demosaic = KFN(demosaic),
+	.pack_planar = KFN(pack_planar),
+	.pack_nv12 = KFN(pack_nv12),
+	.pack_yuy2 = KFN(pack_yuy2),
+};
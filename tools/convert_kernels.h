@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Row kernels of the GRBG10 converter
+ *
+ * convert_kernels.c is compiled once per instruction set with
+ * CONVERT_KERNEL_SUFFIX set; the loops are written to be vectorised by
+ * the compiler for whichever target the object is built for.
+ *
+ * A raw row is held as two half-width planes, even and odd columns, with
+ * one element of padding on either side so neighbours are plain offsets.
+ * In GRBG order, even rows hold G (even) and R (odd) and odd rows hold
+ * B (even) and G (odd).
+ */
+#ifndef GC2607_CONVERT_KERNELS_H
+#define GC2607_CONVERT_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Gains are Q8 fixed point, 256 = 1.0 */
+#define CONVERT_GAIN_SHIFT	8
+#define CONVERT_MAX		1023
+
+/* Per-quad output of the demosaic step, one entry per 2x2 Bayer quad */
+struct convert_quads {
+	uint8_t *y00, *y01;	/* Top row, even and odd column */
+	uint8_t *y10, *y11;	/* Bottom row */
+	uint8_t *u0, *v0;	/* Chroma of the top pixel pair */
+	uint8_t *u1, *v1;	/* Chroma of the bottom pixel pair */
+};
+
+struct convert_kernels {
+	const char *name;
+
+	/*
+	 * Split one raw row into @even/@odd planes of @half pixels, subtract
+	 * @black and apply the Q8 gain of each plane, clamped to 10 bits.
+	 */
+	void (*unpack16)(const uint16_t *src, unsigned int half, int black,
+			 int gain_even, int gain_odd, int16_t *even,
+			 int16_t *odd);
+	void (*unpack10p)(const uint8_t *src, unsigned int half, int black,
+			  int gain_even, int gain_odd, int16_t *even,
+			  int16_t *odd);
+
+	/*
+	 * Demosaic the quads of raw rows b (even) and c (odd), with rows a
+	 * and d the neighbours above and below, and convert them to YUV.
+	 */
+	void (*demosaic)(const int16_t *ea, const int16_t *oa,
+			 const int16_t *eb, const int16_t *ob,
+			 const int16_t *ec, const int16_t *oc,
+			 const int16_t *ed, const int16_t *od,
+			 unsigned int half, const struct convert_quads *q);
+
+	/*
+	 * Write a row pair of quads. Planar/semi-planar outputs take the two
+	 * luma rows and one chroma row; YUY2 takes two packed rows in @y0/@y1.
+	 */
+	void (*pack_planar)(const struct convert_quads *q, unsigned int half,
+			    bool rotate, uint8_t *y0, uint8_t *y1,
+			    uint8_t *u, uint8_t *v);
+	void (*pack_nv12)(const struct convert_quads *q, unsigned int half,
+			  bool rotate, uint8_t *y0, uint8_t *y1, uint8_t *uv);
+	void (*pack_yuy2)(const struct convert_quads *q, unsigned int half,
+			  bool rotate, uint8_t *y0, uint8_t *y1);
+};
+
+extern const struct convert_kernels convert_kernels_scalar;
+#ifdef CONVERT_HAVE_X86
+extern const struct convert_kernels convert_kernels_sse41;
+extern const struct convert_kernels convert_kernels_avx2;
+#endif
+
+#endif /* GC2607_CONVERT_KERNELS_H */
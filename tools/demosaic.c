@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Full-resolution GRBG10 demosaic for the GC2607
+ *
+ * GRBG sites, with the neighbours each missing colour is taken from:
+ *
+ *   even row, even column  G   R left/right,  B above/below
+ *   even row, odd column   R   G cross,       B diagonals
+ *   odd row, even column   B   G cross,       R diagonals
+ *   odd row, odd column    G   B left/right,  R above/below
+ *
+ * Malvar-He-Cutler adds a Laplacian correction from the known channel to
+ * each bilinear estimate. Its kernels are used with doubled coefficients
+ * so they are integers summing to 16.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "demosaic.h"
+#include "pool.h"
+
+#define DEMOSAIC_HALO		2
+#define DEMOSAIC_STRIPE_ROWS	32
+#define DEMOSAIC_MAX		1023
+
+struct demosaic {
+	struct demosaic_params p;
+	struct pool *pool;
+	unsigned int stripes;
+
+	/* One tile per worker: stripe + halo rows, width + halo columns */
+	int16_t *tiles;
+	size_t tile_stride;
+	size_t tile_len;
+
+	/* Frame being processed */
+	const uint8_t *raw;
+	uint16_t *rgb;
+};
+
+int demosaic_parse_method(const char *name, enum demosaic_method *method)
+{
+	if (!strcmp(name, "bilinear"))
+		*method = DEMOSAIC_BILINEAR;
+	else if (!strcmp(name, "mhc"))
+		*method = DEMOSAIC_MHC;
+	else
+		return -EINVAL;
+
+	return 0;
+}
+
+static inline uint16_t clamp10(int v)
+{
+	return v < 0 ? 0 : v > DEMOSAIC_MAX ? DEMOSAIC_MAX : v;
+}
+
+/*
+ * Copy raw rows @y0 - HALO to @y1 + HALO into @tile. Rows and columns
+ * outside the frame mirror about the edge, which keeps their colour.
+ */
+static void load_tile(const struct demosaic *dm, int16_t *tile, int y0, int y1)
+{
+	int width = dm->p.width, height = dm->p.height;
+	size_t ts = dm->tile_stride;
+	int y, x;
+
+	for (y = y0 - DEMOSAIC_HALO; y < y1 + DEMOSAIC_HALO; y++) {
+		int16_t *dst = tile + (y - y0 + DEMOSAIC_HALO) * ts +
+			       DEMOSAIC_HALO;
+		const uint16_t *src;
+		int sy = y;
+
+		if (sy < 0)
+			sy = -sy;
+		else if (sy >= height)
+			sy = 2 * (height - 1) - sy;
+		src = (const uint16_t *)(dm->raw + sy * dm->p.stride);
+
+		for (x = 0; x < width; x++)
+			dst[x] = src[x] & DEMOSAIC_MAX;
+
+		dst[-1] = dst[1];
+		dst[-2] = dst[2];
+		dst[width] = dst[width - 2];
+		dst[width + 1] = dst[width - 3];
+	}
+}
+
+/* Bilinear, two output rows (one Bayer row pair) at a time */
+static void bilinear_rows(const int16_t *restrict t, size_t ts, int width,
+			  uint16_t *restrict out0, uint16_t *restrict out1)
+{
+	const int16_t *restrict n = t - ts;		/* Row above the pair */
+	const int16_t *restrict c0 = t;			/* Even row: G R */
+	const int16_t *restrict c1 = t + ts;		/* Odd row: B G */
+	const int16_t *restrict s = t + 2 * ts;		/* Row below the pair */
+	int x;
+
+	for (x = 0; x < width; x += 2) {
+		/* G at an even row */
+		out0[3 * x] = (c0[x - 1] + c0[x + 1] + 1) >> 1;
+		out0[3 * x + 1] = c0[x];
+		out0[3 * x + 2] = (n[x] + c1[x] + 1) >> 1;
+
+		/* R */
+		out0[3 * x + 3] = c0[x + 1];
+		out0[3 * x + 4] = (c0[x] + c0[x + 2] + n[x + 1] + c1[x + 1] +
+				   2) >> 2;
+		out0[3 * x + 5] = (n[x] + n[x + 2] + c1[x] + c1[x + 2] + 2) >> 2;
+
+		/* B */
+		out1[3 * x] = (c0[x - 1] + c0[x + 1] + s[x - 1] + s[x + 1] +
+			       2) >> 2;
+		out1[3 * x + 1] = (c1[x - 1] + c1[x + 1] + c0[x] + s[x] + 2) >> 2;
+		out1[3 * x + 2] = c1[x];
+
+		/* G at an odd row */
+		out1[3 * x + 3] = (c0[x + 1] + s[x + 1] + 1) >> 1;
+		out1[3 * x + 4] = c1[x + 1];
+		out1[3 * x + 5] = (c1[x] + c1[x + 2] + 1) >> 1;
+	}
+}
+
+/*
+ * Malvar-He-Cutler kernels at pixel p of row c, rows u/d one above/below
+ * and uu/dd two above/below. Results are in 1/16 units.
+ */
+
+/* G at an R or B site */
+#define MHC_G(uu, u, c, d, dd, p)					\
+	(8 * c[p] + 4 * (u[p] + d[p] + c[p - 1] + c[p + 1]) -		\
+	 2 * (uu[p] + dd[p] + c[p - 2] + c[p + 2]))
+
+/* R or B at a G site whose row holds that colour */
+#define MHC_ROW(uu, u, c, d, dd, p)					\
+	(10 * c[p] + 8 * (c[p - 1] + c[p + 1]) -			\
+	 2 * (c[p - 2] + c[p + 2] + u[p - 1] + u[p + 1] + d[p - 1] +	\
+	      d[p + 1]) + (uu[p] + dd[p]))
+
+/* R or B at a G site whose column holds that colour */
+#define MHC_COL(uu, u, c, d, dd, p)					\
+	(10 * c[p] + 8 * (u[p] + d[p]) -				\
+	 2 * (uu[p] + dd[p] + u[p - 1] + u[p + 1] + d[p - 1] +		\
+	      d[p + 1]) + (c[p - 2] + c[p + 2]))
+
+/* B at an R site or R at a B site */
+#define MHC_DIAG(uu, u, c, d, dd, p)					\
+	(12 * c[p] + 4 * (u[p - 1] + u[p + 1] + d[p - 1] + d[p + 1]) -	\
+	 3 * (uu[p] + dd[p] + c[p - 2] + c[p + 2]))
+
+#define MHC_OUT(v)	clamp10(((v) + 8) >> 4)
+
+static void mhc_rows(const int16_t *restrict t, size_t ts, int width,
+		     uint16_t *restrict out0, uint16_t *restrict out1)
+{
+	const int16_t *restrict r_2 = t - 2 * ts;
+	const int16_t *restrict r_1 = t - ts;
+	const int16_t *restrict r0 = t;			/* Even row: G R */
+	const int16_t *restrict r1 = t + ts;		/* Odd row: B G */
+	const int16_t *restrict r2 = t + 2 * ts;
+	const int16_t *restrict r3 = t + 3 * ts;
+	int x;
+
+	for (x = 0; x < width; x += 2) {
+		/* G at an even row: R in the row, B in the column */
+		out0[3 * x] = MHC_OUT(MHC_ROW(r_2, r_1, r0, r1, r2, x));
+		out0[3 * x + 1] = r0[x];
+		out0[3 * x + 2] = MHC_OUT(MHC_COL(r_2, r_1, r0, r1, r2, x));
+
+		/* R */
+		out0[3 * x + 3] = r0[x + 1];
+		out0[3 * x + 4] = MHC_OUT(MHC_G(r_2, r_1, r0, r1, r2, x + 1));
+		out0[3 * x + 5] = MHC_OUT(MHC_DIAG(r_2, r_1, r0, r1, r2, x + 1));
+
+		/* B */
+		out1[3 * x] = MHC_OUT(MHC_DIAG(r_1, r0, r1, r2, r3, x));
+		out1[3 * x + 1] = MHC_OUT(MHC_G(r_1, r0, r1, r2, r3, x));
+		out1[3 * x + 2] = r1[x];
+
+		/* G at an odd row: B in the row, R in the column */
+		out1[3 * x + 3] = MHC_OUT(MHC_COL(r_1, r0, r1, r2, r3, x + 1));
+		out1[3 * x + 4] = r1[x + 1];
+		out1[3 * x + 5] = MHC_OUT(MHC_ROW(r_1, r0, r1, r2, r3, x + 1));
+	}
+}
+
+static void demosaic_stripe(void *ctx, unsigned int stripe,
+			    unsigned int worker)
+{
+	struct demosaic *dm = ctx;
+	unsigned int width = dm->p.width;
+	int y0 = stripe * dm->p.stripe_rows;
+	int y1 = y0 + dm->p.stripe_rows;
+	int16_t *tile = dm->tiles + worker * dm->tile_len;
+	size_t ts = dm->tile_stride;
+	int y;
+
+	if (y1 > (int)dm->p.height)
+		y1 = dm->p.height;
+
+	load_tile(dm, tile, y0, y1);
+
+	for (y = y0; y < y1; y += 2) {
+		const int16_t *t = tile + (y - y0 + DEMOSAIC_HALO) * ts +
+				   DEMOSAIC_HALO;
+		uint16_t *out0 = dm->rgb + (size_t)y * width * 3;
+		uint16_t *out1 = out0 + width * 3;
+
+		if (dm->p.method == DEMOSAIC_MHC)
+			mhc_rows(t, ts, width, out0, out1);
+		else
+			bilinear_rows(t, ts, width, out0, out1);
+	}
+}
+
+struct demosaic *demosaic_create(const struct demosaic_params *params)
+{
+	struct demosaic *dm;
+	unsigned int threads;
+
+	if (params->width < 4 || params->height < 4 || params->width % 2 ||
+	    params->height % 2 || params->stripe_rows % 2) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	dm = calloc(1, sizeof(*dm));
+	if (!dm)
+		return NULL;
+
+	dm->p = *params;
+	if (!dm->p.stride)
+		dm->p.stride = dm->p.width * 2;
+	if (!dm->p.stripe_rows)
+		dm->p.stripe_rows = DEMOSAIC_STRIPE_ROWS;
+	dm->stripes = (dm->p.height + dm->p.stripe_rows - 1) /
+		      dm->p.stripe_rows;
+
+	dm->pool = pool_create(params->threads);
+	if (!dm->pool)
+		goto err;
+	threads = pool_threads(dm->pool);
+
+	/* Round tiles to a cache line so workers never share one */
+	dm->tile_stride = dm->p.width + 2 * DEMOSAIC_HALO;
+	dm->tile_len = (dm->tile_stride *
+			(dm->p.stripe_rows + 2 * DEMOSAIC_HALO) + 31) & ~31UL;
+	dm->tiles = aligned_alloc(64, threads * dm->tile_len * sizeof(int16_t));
+	if (!dm->tiles)
+		goto err;
+
+	return dm;
+
+err:
+	demosaic_destroy(dm);
+	return NULL;
+}
+
+void demosaic_destroy(struct demosaic *dm)
+{
+	if (!dm)
+		return;
+
+	pool_destroy(dm->pool);
+	free(dm->tiles);
+	free(dm);
+}
+
+unsigned int demosaic_threads(const struct demosaic *dm)
+{
+	return pool_threads(dm->pool);
+}
+
+void demosaic_frame(struct demosaic *dm, const void *raw, uint16_t *rgb)
+{
+	dm->raw = raw;
+	dm->rgb = rgb;
+	pool_run(dm->pool, dm->stripes, demosaic_stripe, dm);
+}
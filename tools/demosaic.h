@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Full-resolution GRBG10 demosaic for the GC2607
+ *
+ * The frame is cut into horizontal stripes that are demosaiced in
+ * parallel on a work-stealing thread pool. Each worker copies its stripe
+ * plus two halo rows above and below into a private tile with mirrored
+ * borders, so the interpolation loops never test for frame edges.
+ */
+#ifndef GC2607_DEMOSAIC_H
+#define GC2607_DEMOSAIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum demosaic_method {
+	DEMOSAIC_BILINEAR,
+	DEMOSAIC_MHC,		/* Malvar-He-Cutler 5x5 gradient-corrected */
+};
+
+struct demosaic_params {
+	unsigned int width;		/* Even, in pixels */
+	unsigned int height;		/* Even, in lines */
+	size_t stride;			/* Bytes per raw line, 0 = width * 2 */
+	enum demosaic_method method;
+	unsigned int threads;		/* 0 = one per online CPU */
+	unsigned int stripe_rows;	/* Even, 0 = default */
+};
+
+struct demosaic;
+
+struct demosaic *demosaic_create(const struct demosaic_params *params);
+void demosaic_destroy(struct demosaic *dm);
+
+/*
+ * Demosaic one frame of 16-bit little-endian GRBG10 into interleaved RGB
+ * with 10-bit samples, @rgb holding width * height * 3 values.
+ */
+void demosaic_frame(struct demosaic *dm, const void *raw, uint16_t *rgb);
+
+unsigned int demosaic_threads(const struct demosaic *dm);
+int demosaic_parse_method(const char *name, enum demosaic_method *method);
+
+#endif /* GC2607_DEMOSAIC_H */
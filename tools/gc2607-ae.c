@@ -0,0 +1,382 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-ae - measure the auto-exposure loop on a replayed capture
+ *
+ * The raw frames of a capture recorded at known exposure and gain are
+ * replayed through a model of the sensor: each frame is rescaled by the
+ * ratio of the exposure x gain in effect to the recorded one, with the
+ * write-to-frame delay of the real sensor and clipping at 10 bits. The
+ * controller sees exactly what it would see live and drives the model,
+ * so convergence time and frame-to-frame flicker can be measured
+ * repeatably. --light changes the scene brightness mid-sequence.
+ *
+ *   gc2607-ae --recorded 2002,1012 cap.raw
+ *   gc2607-ae --recorded 1000,130 --start 4,64 --light 60,0.25 -v cap.raw
+ *
+ * The live controller runs in gc2607-loopback --ae.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ae.h"
+#include "sensor.h"
+#include "stats.h"
+
+#define MAX_LIGHT_STEPS	16
+#define SIM_QUEUE	8
+
+struct light_step {
+	unsigned int frame;
+	double factor;
+};
+
+/* Sensor model: writes made after frame n apply from frame n + delay */
+struct sim {
+	struct ae_setting current;
+	struct {
+		unsigned int frame;
+		struct ae_setting setting;
+	} queue[SIM_QUEUE];
+	unsigned int count;
+};
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s --recorded EXPOSURE,GAIN [options] <input.raw>\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH          Frame size (default 1920x1080)\n"
+		"  -r, --recorded E,G      Exposure and analogue_gain of the capture\n"
+		"  -S, --start E,G         Settings the loop starts from (default 4,64)\n"
+		"  -e, --exposure MIN,MAX  Exposure range in lines (default 4,2002)\n"
+		"  -g, --gain MIN,MAX      Gain range, 1/64 units (default 64,1012,\n"
+		"                          up to 4048 with digital gain)\n"
+		"  -t, --target LEVEL      Mean green above black, 10-bit (default 320)\n"
+		"  -b, --black LEVEL       Black level in 10-bit units (default 0)\n"
+		"  -p, --speed S           Share of the error corrected per frame (default 0.5)\n"
+		"      --tolerance T       Relative deadband (default 0.05)\n"
+		"  -d, --delay N           Apply delay assumed by the loop (default 2)\n"
+		"  -D, --sensor-delay N    Apply delay of the sensor model (default 2)\n"
+		"  -l, --light F,X         From frame F scale the scene by X (repeatable)\n"
+		"  -n, --frames N          Frames to run (default 150)\n"
+		"  -x, --skip X,Y          Statistics sampling (default 2,2)\n"
+		"  -v, --verbose           Print every frame\n",
+		argv0);
+}
+
+static void sim_write(struct sim *sim, unsigned int frame,
+		      const struct ae_setting *s)
+{
+	if (sim->count == SIM_QUEUE)
+		return;
+
+	sim->queue[sim->count].frame = frame;
+	sim->queue[sim->count].setting = *s;
+	sim->count++;
+}
+
+static void sim_advance(struct sim *sim, unsigned int frame)
+{
+	unsigned int i = 0, j;
+
+	while (i < sim->count && sim->queue[i].frame <= frame)
+		sim->current = sim->queue[i++].setting;
+
+	for (j = 0; i < sim->count; i++, j++)
+		sim->queue[j] = sim->queue[i];
+	sim->count = j;
+}
+
+/* Frame as the sensor would have produced it at @scale x the recording */
+static void sim_frame(const uint16_t *src, uint16_t *dst, size_t pixels,
+		      unsigned int black, double scale)
+{
+	unsigned int q = scale * 4096 + 0.5;
+	size_t i;
+
+	for (i = 0; i < pixels; i++) {
+		int v = src[i] & 1023;
+		unsigned int out;
+
+		if (v <= (int)black || v == 1023) {
+			dst[i] = v == 1023 && scale >= 1 ? 1023 : v;
+			continue;
+		}
+
+		out = black + ((v - black) * q >> 12);
+		dst[i] = out > 1023 ? 1023 : out;
+	}
+}
+
+static double light_at(const struct light_step *steps, unsigned int n,
+		       unsigned int frame)
+{
+	double factor = 1;
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		if (frame >= steps[i].frame)
+			factor = steps[i].factor;
+
+	return factor;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "recorded", required_argument, NULL, 'r' },
+		{ "start", required_argument, NULL, 'S' },
+		{ "exposure", required_argument, NULL, 'e' },
+		{ "gain", required_argument, NULL, 'g' },
+		{ "target", required_argument, NULL, 't' },
+		{ "black", required_argument, NULL, 'b' },
+		{ "speed", required_argument, NULL, 'p' },
+		{ "tolerance", required_argument, NULL, 'T' },
+		{ "delay", required_argument, NULL, 'd' },
+		{ "sensor-delay", required_argument, NULL, 'D' },
+		{ "light", required_argument, NULL, 'l' },
+		{ "frames", required_argument, NULL, 'n' },
+		{ "skip", required_argument, NULL, 'x' },
+		{ "verbose", no_argument, NULL, 'v' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	struct stats_params sp = {
+		.width = 1920,
+		.height = 1080,
+		.skip_x = 2,
+		.skip_y = 2,
+	};
+	struct ae_params ap = {
+		.target = 320,
+		.exposure_min = 4,
+		.exposure_max = 2002,
+		.gain_min = GC2607_GAIN_MIN,
+		.gain_max = GC2607_GAIN_MAX,
+		.gain_unit = GC2607_GAIN_UNIT,
+		.delay = 2,
+		.speed = 0.5,
+		.tolerance = 0.05,
+		.clip_limit = 0.02,
+	};
+	struct light_step light[MAX_LIGHT_STEPS];
+	unsigned int rec_exposure = 0, start_exposure = 4, sensor_delay = 2;
+	unsigned int nlight = 0, frames = 150, raw_frames, f, writes = 0;
+	unsigned int rec_gain = 0, start_gain = GC2607_GAIN_MIN;
+	unsigned int segment_start = 0, converged_at = 0, segment_writes = 0;
+	double dev_sum = 0, dev_max = 0, prev_level = 0;
+	unsigned int dev_count = 0;
+	bool verbose = false, converged = false;
+	struct ae_setting start, rec;
+	struct stats_engine *eng;
+	uint16_t *raw, *frame;
+	size_t pixels, frame_size;
+	struct sim sim = { };
+	struct stat sb;
+	struct ae *ae;
+	double rec_total;
+	int fd, opt;
+
+	while ((opt = getopt_long(argc, argv, "s:r:S:e:g:t:b:p:d:D:l:n:x:vh",
+				  long_opts, NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &sp.width, &sp.height) != 2)
+				goto bad;
+			break;
+		case 'r':
+			if (sscanf(optarg, "%u,%u", &rec_exposure, &rec_gain) != 2)
+				goto bad;
+			break;
+		case 'S':
+			if (sscanf(optarg, "%u,%u", &start_exposure,
+				   &start_gain) != 2)
+				goto bad;
+			break;
+		case 'e':
+			if (sscanf(optarg, "%u,%u", &ap.exposure_min,
+				   &ap.exposure_max) != 2)
+				goto bad;
+			break;
+		case 'g':
+			if (sscanf(optarg, "%u,%u", &ap.gain_min,
+				   &ap.gain_max) != 2)
+				goto bad;
+			break;
+		case 't':
+			ap.target = strtod(optarg, NULL);
+			break;
+		case 'b':
+			ap.black_level = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			ap.speed = strtod(optarg, NULL);
+			break;
+		case 'T':
+			ap.tolerance = strtod(optarg, NULL);
+			break;
+		case 'd':
+			ap.delay = strtoul(optarg, NULL, 0);
+			break;
+		case 'D':
+			sensor_delay = strtoul(optarg, NULL, 0);
+			break;
+		case 'l':
+			if (nlight == MAX_LIGHT_STEPS ||
+			    sscanf(optarg, "%u,%lf", &light[nlight].frame,
+				   &light[nlight].factor) != 2)
+				goto bad;
+			nlight++;
+			break;
+		case 'n':
+			frames = strtoul(optarg, NULL, 0);
+			break;
+		case 'x':
+			if (sscanf(optarg, "%u,%u", &sp.skip_x, &sp.skip_y) != 2)
+				goto bad;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			goto bad;
+		}
+	}
+
+	if (argc - optind != 1 || !rec_exposure || !rec_gain)
+		goto bad;
+
+	fd = open(argv[optind], O_RDONLY);
+	if (fd < 0 || fstat(fd, &sb) < 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	pixels = (size_t)sp.width * sp.height;
+	frame_size = pixels * 2;
+	raw_frames = sb.st_size / frame_size;
+	if (!raw_frames) {
+		fprintf(stderr, "%s: less than one %ux%u frame\n", argv[optind],
+			sp.width, sp.height);
+		return 1;
+	}
+
+	raw = mmap(NULL, raw_frames * frame_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	frame = malloc(frame_size);
+	if (raw == MAP_FAILED || !frame) {
+		perror("mmap");
+		return 1;
+	}
+
+	eng = stats_create(&sp);
+	start.exposure = start_exposure;
+	start.gain = start_gain;
+	rec.exposure = rec_exposure;
+	rec.gain = rec_gain;
+	ae = ae_create(&ap, &start);
+	if (!eng || !ae) {
+		fprintf(stderr, "Bad parameters: %s\n", strerror(errno));
+		return 1;
+	}
+
+	rec_total = ae_total(ae, &rec);
+	sim.current = start;
+
+	printf("%u frames from %s (%u recorded at exposure %u, gain %u), target %.0f\n",
+	       frames, argv[optind], raw_frames, rec_exposure, rec_gain,
+	       ap.target);
+	if (verbose)
+		printf("frame  light  exposure gain   level  write\n");
+
+	for (f = 0; f <= frames; f++) {
+		struct ae_setting next;
+		struct ae_status status;
+		double scale, dev;
+		bool write;
+
+		/* Report the segment that ends at a light step or at the end */
+		if (f == frames || (f > segment_start && light_at(light, nlight, f) !=
+							  light_at(light, nlight, f - 1))) {
+			printf("frames %3u-%3u light x%-5.2f: ", segment_start,
+			       f - 1, light_at(light, nlight, segment_start));
+			if (converged)
+				printf("converged in %2u frames, %u writes, flicker %.2f%% mean %.2f%% max\n",
+				       converged_at - segment_start,
+				       segment_writes,
+				       dev_count ? 100 * dev_sum / dev_count : 0,
+				       100 * dev_max);
+			else
+				printf("not converged, %u writes\n",
+				       segment_writes);
+
+			if (f == frames)
+				break;
+			segment_start = f;
+			converged = false;
+			segment_writes = 0;
+			dev_sum = dev_max = 0;
+			dev_count = 0;
+		}
+
+		sim_advance(&sim, f);
+		scale = ae_total(ae, &sim.current) / rec_total *
+			light_at(light, nlight, f);
+		sim_frame(raw + (f % raw_frames) * pixels, frame, pixels,
+			  ap.black_level, scale);
+
+		write = ae_process(ae, f, stats_frame(eng, frame), &next,
+				   &status);
+		if (write) {
+			sim_write(&sim, f + sensor_delay, &next);
+			writes++;
+			segment_writes++;
+		}
+
+		/* Converged once within tolerance; flicker is measured from there */
+		if (!converged && fabs(status.level / ap.target - 1) <=
+				  ap.tolerance) {
+			converged = true;
+			converged_at = f;
+		} else if (converged) {
+			dev = fabs(status.level / prev_level - 1);
+			dev_sum += dev;
+			dev_count++;
+			if (dev > dev_max)
+				dev_max = dev;
+		}
+		prev_level = status.level;
+
+		if (verbose)
+			printf("%5u %6.2f %9u %4u %7.1f  %s\n", f,
+			       light_at(light, nlight, f), sim.current.exposure,
+			       sim.current.gain,
+			       status.level, write ? "*" : "");
+	}
+
+	printf("%u control writes in total\n", writes);
+
+	ae_destroy(ae);
+	stats_destroy(eng);
+	free(frame);
+	munmap(raw, raw_frames * frame_size);
+	close(fd);
+	return 0;
+
+bad:
+	usage(argv[0]);
+	return 1;
+}
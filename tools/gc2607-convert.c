@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-convert - convert or benchmark recorded GC2607 raw captures
+ *
+ * Capture frames with e.g.
+ *   v4l2-ctl -d /dev/video0 --stream-mmap --stream-count=30 --stream-to=cap.raw
+ * then
+ *   gc2607-convert cap.raw cap.yuv            # I420, rotated, with WB
+ *   gc2607-convert --bench cap.raw            # ms/frame for every kernel
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "convert.h"
+
+/* Gray world gains measured on the MateBook, as used by the camera scripts */
+#define DEFAULT_WB_R	1.034f
+#define DEFAULT_WB_G	1.000f
+#define DEFAULT_WB_B	1.246f
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <input.raw> <output.yuv>\n"
+		"       %s --bench [options] <input.raw>\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH        Frame size (default 1920x1080)\n"
+		"  -f, --format FMT      i420, nv12 or yuy2 (default i420)\n"
+		"  -p, --packed          Input is CSI-2 packed RAW10 (default 16-bit)\n"
+		"      --stride BYTES    Bytes per raw line (default: no padding)\n"
+		"  -b, --black LEVEL     Black level in 10-bit units (default 0)\n"
+		"  -w, --wb R,G,B        White balance gains (default %.3f,%.3f,%.3f)\n"
+		"      --bayer ORDER     grbg, rggb, bggr or gbrg (default grbg)\n"
+		"  -n, --no-rotate       Do not rotate by 180 degrees; only GRBG\n"
+		"                        captures, taken unflipped, are rotated\n"
+		"  -k, --kernel NAME     Force a kernel:",
+		argv0, argv0, DEFAULT_WB_R, DEFAULT_WB_G, DEFAULT_WB_B);
+
+	for (const char *const *k = convert_kernels(); *k; k++)
+		fprintf(stderr, " %s", *k);
+
+	fprintf(stderr,
+		"\n"
+		"      --bench           Report ms/frame instead of writing output\n"
+		"  -i, --iterations N    Benchmark passes over the input (default 20)\n");
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int bench_kernel(struct convert_params *params, const char *kernel,
+			const uint8_t *raw, unsigned int frames,
+			unsigned int iterations, uint8_t *out)
+{
+	size_t in_size = convert_input_size(params);
+	double best = 1e9, total = 0;
+	struct convert *conv;
+	unsigned int i, f;
+
+	params->kernel = kernel;
+	conv = convert_create(params);
+	if (!conv) {
+		fprintf(stderr, "%s: %s\n", kernel, strerror(errno));
+		return -1;
+	}
+
+	/* One untimed pass to fault in the output and warm the caches */
+	convert_frame(conv, raw, out);
+
+	for (i = 0; i < iterations; i++) {
+		for (f = 0; f < frames; f++) {
+			double start = now_ms(), ms;
+
+			convert_frame(conv, raw + f * in_size, out);
+			ms = now_ms() - start;
+			total += ms;
+			if (ms < best)
+				best = ms;
+		}
+	}
+
+	printf("%-8s %8.3f ms/frame avg %8.3f ms/frame min %8.1f Mpix/s\n",
+	       kernel, total / (iterations * frames), best,
+	       params->width * params->height / (total / (iterations * frames)) / 1e3);
+
+	convert_destroy(conv);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "format", required_argument, NULL, 'f' },
+		{ "packed", no_argument, NULL, 'p' },
+		{ "stride", required_argument, NULL, 'S' },
+		{ "black", required_argument, NULL, 'b' },
+		{ "wb", required_argument, NULL, 'w' },
+		{ "bayer", required_argument, NULL, 'O' },
+		{ "no-rotate", no_argument, NULL, 'n' },
+		{ "kernel", required_argument, NULL, 'k' },
+		{ "bench", no_argument, NULL, 'B' },
+		{ "iterations", required_argument, NULL, 'i' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	struct convert_params params = {
+		.width = 1920,
+		.height = 1080,
+		.format = CONVERT_I420,
+		.wb_r = DEFAULT_WB_R,
+		.wb_g = DEFAULT_WB_G,
+		.wb_b = DEFAULT_WB_B,
+	};
+	unsigned int iterations = 20, frames, f;
+	const char *kernel = NULL;
+	size_t in_size, out_size;
+	struct convert *conv;
+	bool bench = false, rotate = true;
+	struct stat st;
+	uint8_t *raw, *out;
+	FILE *fout;
+	int fd, opt;
+
+	while ((opt = getopt_long(argc, argv, "s:f:pb:w:nk:i:h", long_opts,
+				  NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &params.width,
+				   &params.height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'f':
+			if (convert_parse_format(optarg, &params.format)) {
+				fprintf(stderr, "Unknown format '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'p':
+			params.packed = true;
+			break;
+		case 'S':
+			params.stride = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			params.black_level = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			if (sscanf(optarg, "%f,%f,%f", &params.wb_r, &params.wb_g,
+				   &params.wb_b) != 3) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'O':
+			if (bayer_parse(optarg, &params.bayer)) {
+				fprintf(stderr, "Unknown Bayer order '%s'\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'n':
+			rotate = false;
+			break;
+		case 'k':
+			kernel = optarg;
+			break;
+		case 'B':
+			bench = true;
+			break;
+		case 'i':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != (bench ? 1 : 2) || !iterations) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	/* A flipped readout is already the right way up */
+	params.rotate180 = rotate && params.bayer == BAYER_GRBG;
+
+	fd = open(argv[optind], O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	in_size = convert_input_size(&params);
+	frames = st.st_size / in_size;
+	if (!frames) {
+		fprintf(stderr, "%s: %lld bytes, less than one %ux%u frame (%zu bytes)\n",
+			argv[optind], (long long)st.st_size, params.width,
+			params.height, in_size);
+		return 1;
+	}
+
+	raw = mmap(NULL, frames * in_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (raw == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	out_size = convert_output_size(&params);
+	out = malloc(out_size);
+	if (!out) {
+		perror("malloc");
+		return 1;
+	}
+
+	if (bench) {
+		printf("%ux%u %s, %u frame(s) x %u iterations\n", params.width,
+		       params.height, params.packed ? "RAW10 packed" : "RAW10 16-bit",
+		       frames, iterations);
+
+		if (kernel)
+			return bench_kernel(&params, kernel, raw, frames,
+					    iterations, out) ? 1 : 0;
+
+		for (const char *const *k = convert_kernels(); *k; k++)
+			bench_kernel(&params, *k, raw, frames, iterations, out);
+		return 0;
+	}
+
+	params.kernel = kernel;
+	conv = convert_create(&params);
+	if (!conv) {
+		fprintf(stderr, "Cannot create converter: %s\n", strerror(errno));
+		return 1;
+	}
+
+	fout = fopen(argv[optind + 1], "wb");
+	if (!fout) {
+		perror(argv[optind + 1]);
+		return 1;
+	}
+
+	for (f = 0; f < frames; f++) {
+		convert_frame(conv, raw + f * in_size, out);
+		if (fwrite(out, out_size, 1, fout) != 1) {
+			perror(argv[optind + 1]);
+			return 1;
+		}
+	}
+
+	fclose(fout);
+	fprintf(stderr, "Converted %u frame(s) with the %s kernel\n", frames,
+		convert_kernel_name(conv));
+	convert_destroy(conv);
+	free(out);
+	munmap(raw, frames * in_size);
+	close(fd);
+	return 0;
+}
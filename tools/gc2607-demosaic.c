@@ -0,0 +1,348 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-demosaic - full-resolution demosaic of GC2607 raw captures
+ *
+ *   gc2607-demosaic -m mhc -g 4 cap.raw cap.ppm   # first frame to PPM
+ *   gc2607-demosaic --bench cap.raw               # thread count sweep
+ *   gc2607-demosaic --bench                       # same, synthetic frame
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "demosaic.h"
+
+#define MAX_SWEEP	32
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <input.raw> <output.ppm>\n"
+		"       %s --bench [options] [input.raw]\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH        Frame size (default 1920x1080)\n"
+		"  -m, --method NAME     bilinear or mhc (default mhc)\n"
+		"  -t, --threads N[,N..] Worker threads, or the list to sweep\n"
+		"                        (default: one per CPU, sweep 1,2,4,..,CPUs)\n"
+		"      --stripe ROWS     Rows per stripe (default 32)\n"
+		"  -g, --gain G          Brightness multiplier for the PPM (default 1.0)\n"
+		"  -w, --wb R,G,B        White balance gains for the PPM (default 1,1,1)\n"
+		"      --bench           Report ms/frame instead of writing output\n"
+		"  -i, --iterations N    Benchmark frames per configuration (default 20)\n",
+		argv0, argv0);
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Smooth gradients with Bayer colour structure and some sensor noise */
+static uint16_t *synthetic_frame(unsigned int width, unsigned int height)
+{
+	uint16_t *raw = malloc((size_t)width * height * 2);
+	unsigned int x, y, seed = 1;
+
+	if (!raw)
+		return NULL;
+
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			unsigned int v = (x * 3 + y * 2) % 800 + 64;
+
+			if (!(y & 1) && (x & 1))
+				v = v * 3 / 4;
+			else if ((y & 1) && !(x & 1))
+				v /= 2;
+			seed = seed * 1103515245 + 12345;
+			raw[(size_t)y * width + x] = v + (seed >> 16) % 16;
+		}
+	}
+
+	return raw;
+}
+
+static int write_ppm(const char *path, const uint16_t *rgb, unsigned int width,
+		     unsigned int height, float gain, const float wb[3])
+{
+	size_t i, n = (size_t)width * height * 3;
+	uint8_t *line = malloc(width * 3);
+	int scale[3];
+	FILE *f;
+
+	if (!line)
+		return -1;
+
+	f = fopen(path, "wb");
+	if (!f) {
+		free(line);
+		return -1;
+	}
+
+	/* 10-bit to 8-bit with gain, Q8 */
+	for (i = 0; i < 3; i++)
+		scale[i] = gain * wb[i] * 256 / 4 + 0.5f;
+
+	fprintf(f, "P6\n%u %u\n255\n", width, height);
+	for (i = 0; i < n; i++) {
+		int v = rgb[i] * scale[i % 3] >> 8;
+
+		line[i % (width * 3)] = v > 255 ? 255 : v;
+		if (i % (width * 3) == width * 3 - 1)
+			fwrite(line, width * 3, 1, f);
+	}
+
+	free(line);
+	return fclose(f);
+}
+
+static int parse_threads(const char *arg, unsigned int *list)
+{
+	unsigned int n = 0;
+	char *end;
+
+	do {
+		if (n == MAX_SWEEP)
+			return -1;
+		list[n++] = strtoul(arg, &end, 0);
+		arg = end + 1;
+	} while (*end == ',');
+
+	return *end ? -1 : (int)n;
+}
+
+static int default_sweep(unsigned int *list)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int t, n = 0;
+
+	if (cpus < 1)
+		cpus = 1;
+
+	for (t = 1; t < cpus && n < MAX_SWEEP - 1; t *= 2)
+		list[n++] = t;
+	list[n++] = cpus;
+
+	return n;
+}
+
+static void bench(struct demosaic_params *params, const unsigned int *threads,
+		  unsigned int count, const void *raw, unsigned int iterations,
+		  uint16_t *rgb)
+{
+	double base = 0;
+	unsigned int i, n;
+
+	printf("%-9s %7s %10s %10s %10s %8s\n", "method", "threads", "avg ms",
+	       "min ms", "Mpix/s", "speedup");
+
+	for (i = 0; i < count; i++) {
+		struct demosaic *dm;
+		double total = 0, best = 1e9, avg;
+
+		params->threads = threads[i];
+		dm = demosaic_create(params);
+		if (!dm) {
+			fprintf(stderr, "demosaic_create: %s\n", strerror(errno));
+			return;
+		}
+
+		/* Untimed frame to start the threads and fault in the output */
+		demosaic_frame(dm, raw, rgb);
+
+		for (n = 0; n < iterations; n++) {
+			double start = now_ms(), ms;
+
+			demosaic_frame(dm, raw, rgb);
+			ms = now_ms() - start;
+			total += ms;
+			if (ms < best)
+				best = ms;
+		}
+
+		avg = total / iterations;
+		if (!base)
+			base = avg;
+
+		printf("%-9s %7u %10.3f %10.3f %10.1f %7.2fx\n",
+		       params->method == DEMOSAIC_MHC ? "mhc" : "bilinear",
+		       demosaic_threads(dm), avg, best,
+		       params->width * params->height / avg / 1e3, base / avg);
+		demosaic_destroy(dm);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "method", required_argument, NULL, 'm' },
+		{ "threads", required_argument, NULL, 't' },
+		{ "stripe", required_argument, NULL, 'S' },
+		{ "gain", required_argument, NULL, 'g' },
+		{ "wb", required_argument, NULL, 'w' },
+		{ "bench", no_argument, NULL, 'B' },
+		{ "iterations", required_argument, NULL, 'i' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	struct demosaic_params params = {
+		.width = 1920,
+		.height = 1080,
+		.method = DEMOSAIC_MHC,
+	};
+	unsigned int threads[MAX_SWEEP], nthreads = 0, iterations = 20;
+	bool bench_mode = false, method_set = false;
+	float gain = 1.0f, wb[3] = { 1.0f, 1.0f, 1.0f };
+	size_t frame_size, rgb_size;
+	void *raw = NULL;
+	struct demosaic *dm;
+	uint16_t *rgb;
+	int opt, ret;
+
+	while ((opt = getopt_long(argc, argv, "s:m:t:g:w:i:h", long_opts,
+				  NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &params.width,
+				   &params.height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'm':
+			if (demosaic_parse_method(optarg, &params.method)) {
+				fprintf(stderr, "Unknown method '%s'\n", optarg);
+				return 1;
+			}
+			method_set = true;
+			break;
+		case 't':
+			ret = parse_threads(optarg, threads);
+			if (ret < 0) {
+				usage(argv[0]);
+				return 1;
+			}
+			nthreads = ret;
+			break;
+		case 'S':
+			params.stripe_rows = strtoul(optarg, NULL, 0);
+			break;
+		case 'g':
+			gain = strtof(optarg, NULL);
+			break;
+		case 'w':
+			if (sscanf(optarg, "%f,%f,%f", &wb[0], &wb[1],
+				   &wb[2]) != 3) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'B':
+			bench_mode = true;
+			break;
+		case 'i':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if ((bench_mode ? argc - optind > 1 : argc - optind != 2) ||
+	    !iterations) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	frame_size = (size_t)params.width * params.height * 2;
+	rgb_size = (size_t)params.width * params.height * 3 * sizeof(*rgb);
+
+	if (optind < argc) {
+		struct stat st;
+		int fd = open(argv[optind], O_RDONLY);
+
+		if (fd < 0 || fstat(fd, &st) < 0) {
+			perror(argv[optind]);
+			return 1;
+		}
+		if ((size_t)st.st_size < frame_size) {
+			fprintf(stderr, "%s: %lld bytes, less than one %ux%u frame (%zu bytes)\n",
+				argv[optind], (long long)st.st_size,
+				params.width, params.height, frame_size);
+			return 1;
+		}
+
+		raw = mmap(NULL, frame_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (raw == MAP_FAILED) {
+			perror("mmap");
+			return 1;
+		}
+	} else {
+		raw = synthetic_frame(params.width, params.height);
+		if (!raw) {
+			perror("malloc");
+			return 1;
+		}
+	}
+
+	rgb = malloc(rgb_size);
+	if (!rgb) {
+		perror("malloc");
+		return 1;
+	}
+
+	if (bench_mode) {
+		printf("%ux%u GRBG10 %s, %u frames per configuration\n",
+		       params.width, params.height,
+		       optind < argc ? argv[optind] : "synthetic", iterations);
+
+		if (!nthreads)
+			nthreads = default_sweep(threads);
+
+		if (method_set) {
+			bench(&params, threads, nthreads, raw, iterations, rgb);
+		} else {
+			params.method = DEMOSAIC_BILINEAR;
+			bench(&params, threads, nthreads, raw, iterations, rgb);
+			params.method = DEMOSAIC_MHC;
+			bench(&params, threads, nthreads, raw, iterations, rgb);
+		}
+		return 0;
+	}
+
+	params.threads = nthreads ? threads[0] : 0;
+	dm = demosaic_create(&params);
+	if (!dm) {
+		fprintf(stderr, "demosaic_create: %s\n", strerror(errno));
+		return 1;
+	}
+
+	demosaic_frame(dm, raw, rgb);
+	demosaic_destroy(dm);
+
+	if (write_ppm(argv[optind + 1], rgb, params.width, params.height, gain,
+		      wb)) {
+		perror(argv[optind + 1]);
+		return 1;
+	}
+
+	free(rgb);
+	munmap(raw, frame_size);
+	return 0;
+}
@@ -0,0 +1,807 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-loopback - feed GC2607 frames to a v4l2loopback device
+ *
+ * Replaces the GStreamer bayer2rgb pipeline of the camera scripts. Raw
+ * frames are dequeued from the capture node, converted by the native
+ * converter straight into a mmapped v4l2loopback output buffer and queued
+ * there, so the only pass over each frame is the conversion itself. Both
+ * sides use a fixed ring of driver-allocated buffers set up at start; the
+ * loop allocates nothing.
+ *
+ *   gc2607-loopback /dev/video0 /dev/video10
+ *
+ * The capture buffers are read through their V4L2 mmap by default. With
+ * --dmabuf they are exported with VIDIOC_EXPBUF and read through the
+ * dma-buf mapping, bracketed by DMA_BUF_IOCTL_SYNC so the CPU view is
+ * coherent on non-snooping platforms.
+ *
+ * Any capture device with a 10-bit Bayer format works, so the daemon can
+ * be tested without the sensor using vivid (see test_loopback.sh). The
+ * Bayer order is taken from the capture node's current format, which
+ * init_camera.sh sets from the sensor, and follows the sensor's flip
+ * controls. init_camera.sh turns both flips on for the upside-down module,
+ * giving a GBRG readout that needs no rotation; only an unflipped GRBG
+ * readout, from a sensor without flip controls, is rotated by 180 degrees
+ * in software.
+ *
+ * With --ae the raw statistics of every frame feed the auto-exposure
+ * controller, which writes exposure and analogue gain to the sensor
+ * subdev:
+ *
+ *   gc2607-loopback --ae /dev/v4l-subdev6 /dev/video0 /dev/video10
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/dma-buf.h>
+#include <linux/videodev2.h>
+
+#include "ae.h"
+#include "convert.h"
+#include "sensor.h"
+#include "stats.h"
+
+/* Gray world gains measured on the MateBook, as used by the camera scripts */
+#define DEFAULT_WB_R	1.034f
+#define DEFAULT_WB_G	1.000f
+#define DEFAULT_WB_B	1.246f
+
+#define DEFAULT_BUFFERS	4
+#define DEFAULT_AE_TARGET	320
+#define MAX_BUFFERS	16
+
+struct buffer {
+	void *mem;
+	size_t length;
+	int dmabuf_fd;
+};
+
+struct device {
+	const char *path;
+	int fd;
+	enum v4l2_buf_type type;
+	unsigned int count;
+	struct buffer bufs[MAX_BUFFERS];
+};
+
+/* Min/avg/max of one pipeline stage over a reporting period, in us */
+struct stage {
+	const char *name;
+	double min, max, sum;
+};
+
+enum {
+	STAGE_DEQUEUE,		/* Capture timestamp to VIDIOC_DQBUF return */
+	STAGE_CONVERT,		/* Raw buffer to loopback buffer */
+	STAGE_QUEUE,		/* Output QBUF and capture re-QBUF */
+	STAGE_TOTAL,		/* Capture timestamp to output queued */
+	NUM_STAGES,
+};
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	stop = 1;
+}
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <capture device> <loopback device>\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH        Frame size (default 1920x1080)\n"
+		"  -f, --format FMT      Loopback format: i420, nv12 or yuy2 (default yuy2)\n"
+		"  -p, --packed          Capture CSI-2 packed RAW10 (default 16-bit)\n"
+		"  -b, --black LEVEL     Black level in 10-bit units (default 0)\n"
+		"  -w, --wb R,G,B        White balance gains (default %.3f,%.3f,%.3f)\n"
+		"      --bayer ORDER     grbg, rggb, bggr or gbrg (default: as set\n"
+		"                        on the capture device, else grbg)\n"
+		"  -n, --no-rotate       Do not rotate a GRBG readout by 180 degrees\n"
+		"  -r, --fps N           Frame rate advertised by the loopback device\n"
+		"  -c, --buffers N       Buffers per device (default %u, max %u)\n"
+		"  -d, --dmabuf          Read capture buffers through VIDIOC_EXPBUF\n"
+		"  -k, --kernel NAME     Force a converter kernel\n"
+		"  -i, --interval SEC    Latency report interval, 0 = off (default 5)\n"
+		"  -N, --frames N        Stop after N frames (default: run until killed)\n"
+		"  -a, --ae SUBDEV       Run auto exposure on the sensor subdev\n"
+		"  -t, --target LEVEL    AE mean green above black, 10-bit (default %u)\n",
+		argv0, DEFAULT_WB_R, DEFAULT_WB_G, DEFAULT_WB_B, DEFAULT_BUFFERS,
+		MAX_BUFFERS, DEFAULT_AE_TARGET);
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int xioctl(int fd, unsigned long req, void *arg)
+{
+	int ret;
+
+	do {
+		ret = ioctl(fd, req, arg);
+	} while (ret < 0 && errno == EINTR);
+
+	return ret;
+}
+
+static int open_device(struct device *dev, const char *path,
+		       enum v4l2_buf_type type)
+{
+	struct v4l2_capability cap;
+	__u32 caps;
+
+	dev->path = path;
+	dev->type = type;
+	dev->fd = open(path, O_RDWR);
+	if (dev->fd < 0) {
+		perror(path);
+		return -1;
+	}
+
+	if (xioctl(dev->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+		perror("VIDIOC_QUERYCAP");
+		return -1;
+	}
+
+	caps = cap.capabilities & V4L2_CAP_DEVICE_CAPS ? cap.device_caps :
+							 cap.capabilities;
+	if (!(caps & V4L2_CAP_STREAMING) ||
+	    !(caps & (type == V4L2_BUF_TYPE_VIDEO_CAPTURE ?
+		      V4L2_CAP_VIDEO_CAPTURE : V4L2_CAP_VIDEO_OUTPUT))) {
+		fprintf(stderr, "%s (%s): not a streaming %s device\n", path,
+			cap.card, type == V4L2_BUF_TYPE_VIDEO_CAPTURE ?
+			"capture" : "output");
+		return -1;
+	}
+
+	return 0;
+}
+
+static const __u32 bayer_fourcc[][2] = {		/* 16-bit, packed */
+	[BAYER_GRBG] = { V4L2_PIX_FMT_SGRBG10, V4L2_PIX_FMT_SGRBG10P },
+	[BAYER_RGGB] = { V4L2_PIX_FMT_SRGGB10, V4L2_PIX_FMT_SRGGB10P },
+	[BAYER_BGGR] = { V4L2_PIX_FMT_SBGGR10, V4L2_PIX_FMT_SBGGR10P },
+	[BAYER_GBRG] = { V4L2_PIX_FMT_SGBRG10, V4L2_PIX_FMT_SGBRG10P },
+};
+
+/* Bayer order of the current capture format, if it is a RAW10 one */
+static int get_bayer(struct device *dev, enum bayer_order *order)
+{
+	struct v4l2_format fmt = { .type = dev->type };
+	unsigned int i;
+
+	if (xioctl(dev->fd, VIDIOC_G_FMT, &fmt) < 0)
+		return -1;
+
+	for (i = 0; i < sizeof(bayer_fourcc) / sizeof(bayer_fourcc[0]); i++) {
+		if (fmt.fmt.pix.pixelformat == bayer_fourcc[i][0] ||
+		    fmt.fmt.pix.pixelformat == bayer_fourcc[i][1]) {
+			*order = i;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+static int set_format(struct device *dev, __u32 pixelformat,
+		      unsigned int width, unsigned int height,
+		      unsigned int bytesperline, unsigned int sizeimage,
+		      struct v4l2_pix_format *out)
+{
+	struct v4l2_format fmt = { .type = dev->type };
+
+	fmt.fmt.pix.width = width;
+	fmt.fmt.pix.height = height;
+	fmt.fmt.pix.pixelformat = pixelformat;
+	fmt.fmt.pix.field = V4L2_FIELD_NONE;
+	fmt.fmt.pix.bytesperline = bytesperline;
+	fmt.fmt.pix.sizeimage = sizeimage;
+	fmt.fmt.pix.colorspace = V4L2_COLORSPACE_SMPTE170M;
+
+	if (xioctl(dev->fd, VIDIOC_S_FMT, &fmt) < 0) {
+		fprintf(stderr, "%s: VIDIOC_S_FMT: %s\n", dev->path,
+			strerror(errno));
+		return -1;
+	}
+
+	if (fmt.fmt.pix.pixelformat != pixelformat ||
+	    fmt.fmt.pix.width != width || fmt.fmt.pix.height != height) {
+		fprintf(stderr, "%s: got %.4s %ux%u instead of %.4s %ux%u\n",
+			dev->path, (char *)&fmt.fmt.pix.pixelformat,
+			fmt.fmt.pix.width, fmt.fmt.pix.height,
+			(char *)&pixelformat, width, height);
+		return -1;
+	}
+
+	*out = fmt.fmt.pix;
+	return 0;
+}
+
+/* Allocate and map the buffer ring; capture buffers are mapped read-only */
+static int map_buffers(struct device *dev, unsigned int count, bool dmabuf)
+{
+	struct v4l2_requestbuffers req = {
+		.count = count,
+		.type = dev->type,
+		.memory = V4L2_MEMORY_MMAP,
+	};
+	int prot = dev->type == V4L2_BUF_TYPE_VIDEO_CAPTURE ?
+		   PROT_READ : PROT_READ | PROT_WRITE;
+	unsigned int i;
+
+	if (xioctl(dev->fd, VIDIOC_REQBUFS, &req) < 0) {
+		fprintf(stderr, "%s: VIDIOC_REQBUFS: %s\n", dev->path,
+			strerror(errno));
+		return -1;
+	}
+
+	if (req.count < 2 || req.count > MAX_BUFFERS) {
+		fprintf(stderr, "%s: driver gave %u buffers\n", dev->path,
+			req.count);
+		return -1;
+	}
+
+	for (i = 0; i < req.count; i++) {
+		dev->bufs[i].dmabuf_fd = -1;
+		dev->bufs[i].mem = MAP_FAILED;
+	}
+	dev->count = req.count;
+
+	for (i = 0; i < dev->count; i++) {
+		struct buffer *buf = &dev->bufs[i];
+		struct v4l2_buffer vb = {
+			.index = i,
+			.type = dev->type,
+			.memory = V4L2_MEMORY_MMAP,
+		};
+
+		if (xioctl(dev->fd, VIDIOC_QUERYBUF, &vb) < 0) {
+			perror("VIDIOC_QUERYBUF");
+			return -1;
+		}
+		buf->length = vb.length;
+
+		if (dmabuf) {
+			struct v4l2_exportbuffer exp = {
+				.type = dev->type,
+				.index = i,
+				.flags = O_RDONLY | O_CLOEXEC,
+			};
+
+			if (xioctl(dev->fd, VIDIOC_EXPBUF, &exp) < 0) {
+				perror("VIDIOC_EXPBUF");
+				return -1;
+			}
+			buf->dmabuf_fd = exp.fd;
+			buf->mem = mmap(NULL, vb.length, prot, MAP_SHARED,
+					exp.fd, 0);
+		} else {
+			buf->mem = mmap(NULL, vb.length, prot, MAP_SHARED,
+					dev->fd, vb.m.offset);
+		}
+
+		if (buf->mem == MAP_FAILED) {
+			fprintf(stderr, "%s: mmap buffer %u: %s\n", dev->path,
+				i, strerror(errno));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void close_device(struct device *dev)
+{
+	unsigned int i;
+
+	if (dev->fd < 0)
+		return;
+
+	xioctl(dev->fd, VIDIOC_STREAMOFF, &dev->type);
+
+	for (i = 0; i < dev->count; i++) {
+		if (dev->bufs[i].mem != MAP_FAILED)
+			munmap(dev->bufs[i].mem, dev->bufs[i].length);
+		if (dev->bufs[i].dmabuf_fd >= 0)
+			close(dev->bufs[i].dmabuf_fd);
+	}
+
+	close(dev->fd);
+	dev->fd = -1;
+}
+
+static int queue_buffer(struct device *dev, struct v4l2_buffer *vb)
+{
+	if (xioctl(dev->fd, VIDIOC_QBUF, vb) < 0) {
+		fprintf(stderr, "%s: VIDIOC_QBUF: %s\n", dev->path,
+			strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void dmabuf_sync(const struct buffer *buf, __u64 flags)
+{
+	struct dma_buf_sync sync = { .flags = flags | DMA_BUF_SYNC_READ };
+
+	if (buf->dmabuf_fd >= 0)
+		xioctl(buf->dmabuf_fd, DMA_BUF_IOCTL_SYNC, &sync);
+}
+
+static void stage_reset(struct stage *stages)
+{
+	unsigned int i;
+
+	for (i = 0; i < NUM_STAGES; i++) {
+		stages[i].min = 1e12;
+		stages[i].max = 0;
+		stages[i].sum = 0;
+	}
+}
+
+static void stage_add(struct stage *s, double us)
+{
+	if (us < s->min)
+		s->min = us;
+	if (us > s->max)
+		s->max = us;
+	s->sum += us;
+}
+
+static void stage_report(struct stage *stages, unsigned int frames,
+			 double elapsed_us, unsigned int errors)
+{
+	unsigned int i;
+
+	printf("%u frames, %.1f fps, %u errors", frames,
+	       frames * 1e6 / elapsed_us, errors);
+	for (i = 0; i < NUM_STAGES; i++)
+		printf(" | %s %.0f/%.0f/%.0f us", stages[i].name, stages[i].min,
+		       stages[i].sum / frames, stages[i].max);
+	printf("\n");
+	fflush(stdout);
+}
+
+/*
+ * Start the controller from the exposure and gain the sensor has now. If
+ * the driver has a digital gain control, its range extends the gain.
+ */
+static struct ae *ae_setup(int subdev, struct ae_params *ap, bool *digital)
+{
+	struct ae_setting initial;
+	int min, max, exposure, gain, dgain;
+
+	if (subdev_get_range(subdev, V4L2_CID_ANALOGUE_GAIN, &min, &max,
+			     &gain) < 0) {
+		perror("subdev controls");
+		return NULL;
+	}
+	ap->gain_min = min;
+	ap->gain_max = max;
+	ap->gain_unit = GC2607_GAIN_UNIT;
+
+	*digital = !subdev_get_range(subdev, V4L2_CID_DIGITAL_GAIN, &min, &max,
+				     &dgain);
+	if (*digital) {
+		ap->gain_max = ap->gain_max * max / GC2607_GAIN_UNIT;
+		gain = gain * dgain / GC2607_GAIN_UNIT;
+	}
+
+	if (subdev_get_range(subdev, V4L2_CID_EXPOSURE, &min, &max,
+			     &exposure) < 0) {
+		perror("subdev controls");
+		return NULL;
+	}
+	ap->exposure_min = min;
+	ap->exposure_max = max;
+
+	initial.exposure = exposure;
+	initial.gain = gain;
+
+	return ae_create(ap, &initial);
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "format", required_argument, NULL, 'f' },
+		{ "packed", no_argument, NULL, 'p' },
+		{ "black", required_argument, NULL, 'b' },
+		{ "wb", required_argument, NULL, 'w' },
+		{ "bayer", required_argument, NULL, 'O' },
+		{ "no-rotate", no_argument, NULL, 'n' },
+		{ "fps", required_argument, NULL, 'r' },
+		{ "buffers", required_argument, NULL, 'c' },
+		{ "dmabuf", no_argument, NULL, 'd' },
+		{ "kernel", required_argument, NULL, 'k' },
+		{ "interval", required_argument, NULL, 'i' },
+		{ "frames", required_argument, NULL, 'N' },
+		{ "ae", required_argument, NULL, 'a' },
+		{ "target", required_argument, NULL, 't' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	static const __u32 out_fourcc[] = {
+		[CONVERT_I420] = V4L2_PIX_FMT_YUV420,
+		[CONVERT_NV12] = V4L2_PIX_FMT_NV12,
+		[CONVERT_YUY2] = V4L2_PIX_FMT_YUYV,
+	};
+	struct convert_params params = {
+		.width = 1920,
+		.height = 1080,
+		.format = CONVERT_YUY2,
+		.wb_r = DEFAULT_WB_R,
+		.wb_g = DEFAULT_WB_G,
+		.wb_b = DEFAULT_WB_B,
+	};
+	struct stage stages[NUM_STAGES] = {
+		[STAGE_DEQUEUE] = { .name = "dequeue" },
+		[STAGE_CONVERT] = { .name = "convert" },
+		[STAGE_QUEUE] = { .name = "queue" },
+		[STAGE_TOTAL] = { .name = "total" },
+	};
+	struct ae_params ae_params = {
+		.target = DEFAULT_AE_TARGET,
+		.delay = 2,
+		.speed = 0.5,
+		.tolerance = 0.05,
+		.clip_limit = 0.02,
+	};
+	struct device cap = { .fd = -1 }, out = { .fd = -1 };
+	unsigned int count = DEFAULT_BUFFERS, interval = 5, fps = 0;
+	unsigned int max_frames = 0, frames = 0, period_frames = 0, errors = 0;
+	unsigned int i;
+	bool out_free[MAX_BUFFERS];
+	struct v4l2_pix_format cap_fmt, out_fmt;
+	struct convert *conv = NULL;
+	struct stats_engine *eng = NULL;
+	struct ae *ae = NULL;
+	const char *subdev_path = NULL;
+	bool ae_digital = false;
+	int subdev = -1;
+	double period_start;
+	size_t out_size;
+	bool dmabuf = false, rotate = true, bayer_set = false;
+	int ret = 1, opt;
+
+	while ((opt = getopt_long(argc, argv, "s:f:pb:w:nr:c:dk:i:N:a:t:h",
+				  long_opts, NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &params.width,
+				   &params.height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'f':
+			if (convert_parse_format(optarg, &params.format)) {
+				fprintf(stderr, "Unknown format '%s'\n", optarg);
+				return 1;
+			}
+			break;
+		case 'p':
+			params.packed = true;
+			break;
+		case 'b':
+			params.black_level = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			if (sscanf(optarg, "%f,%f,%f", &params.wb_r, &params.wb_g,
+				   &params.wb_b) != 3) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'O':
+			if (bayer_parse(optarg, &params.bayer)) {
+				fprintf(stderr, "Unknown Bayer order '%s'\n",
+					optarg);
+				return 1;
+			}
+			bayer_set = true;
+			break;
+		case 'n':
+			rotate = false;
+			break;
+		case 'r':
+			fps = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			count = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			dmabuf = true;
+			break;
+		case 'k':
+			params.kernel = optarg;
+			break;
+		case 'i':
+			interval = strtoul(optarg, NULL, 0);
+			break;
+		case 'N':
+			max_frames = strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			subdev_path = optarg;
+			break;
+		case 't':
+			ae_params.target = strtod(optarg, NULL);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != 2 || count < 2 || count > MAX_BUFFERS) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	/* The statistics engine reads 16-bit samples only */
+	if (subdev_path && params.packed) {
+		fprintf(stderr, "--ae needs 16-bit capture, not --packed\n");
+		return 1;
+	}
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+
+	if (open_device(&cap, argv[optind], V4L2_BUF_TYPE_VIDEO_CAPTURE) ||
+	    open_device(&out, argv[optind + 1], V4L2_BUF_TYPE_VIDEO_OUTPUT))
+		goto done;
+
+	if (!bayer_set && get_bayer(&cap, &params.bayer))
+		params.bayer = BAYER_GRBG;
+	params.rotate180 = rotate && params.bayer == BAYER_GRBG;
+
+	/* The capture side decides the raw line stride */
+	if (set_format(&cap, bayer_fourcc[params.bayer][params.packed],
+		       params.width, params.height, 0, 0, &cap_fmt))
+		goto done;
+	params.stride = cap_fmt.bytesperline;
+
+	out_size = convert_output_size(&params);
+	if (set_format(&out, out_fourcc[params.format], params.width,
+		       params.height,
+		       params.format == CONVERT_YUY2 ? params.width * 2 :
+						       params.width,
+		       out_size, &out_fmt))
+		goto done;
+
+	if (fps) {
+		struct v4l2_streamparm parm = { .type = out.type };
+
+		parm.parm.output.timeperframe.numerator = 1;
+		parm.parm.output.timeperframe.denominator = fps;
+		if (xioctl(out.fd, VIDIOC_S_PARM, &parm) < 0)
+			fprintf(stderr, "%s: VIDIOC_S_PARM: %s\n", out.path,
+				strerror(errno));
+	}
+
+	conv = convert_create(&params);
+	if (!conv) {
+		fprintf(stderr, "Cannot create converter: %s\n", strerror(errno));
+		goto done;
+	}
+
+	if (subdev_path) {
+		struct stats_params sp = {
+			.width = params.width,
+			.height = params.height,
+			.stride = params.stride,
+			.skip_x = 2,
+			.skip_y = 2,
+			.bayer = params.bayer,
+		};
+
+		subdev = subdev_open(subdev_path);
+		if (subdev < 0)
+			goto done;
+
+		ae_params.black_level = params.black_level;
+		eng = stats_create(&sp);
+		ae = ae_setup(subdev, &ae_params, &ae_digital);
+		if (!eng || !ae) {
+			fprintf(stderr, "Cannot start auto exposure: %s\n",
+				strerror(errno));
+			goto done;
+		}
+	}
+
+	if (map_buffers(&cap, count, dmabuf) || map_buffers(&out, count, false))
+		goto done;
+
+	for (i = 0; i < cap.count; i++) {
+		if (cap.bufs[i].length < convert_input_size(&params)) {
+			fprintf(stderr, "%s: buffer of %zu bytes, need %zu\n",
+				cap.path, cap.bufs[i].length,
+				convert_input_size(&params));
+			goto done;
+		}
+	}
+
+	for (i = 0; i < out.count; i++) {
+		if (out.bufs[i].length < out_size) {
+			fprintf(stderr, "%s: buffer of %zu bytes, need %zu\n",
+				out.path, out.bufs[i].length, out_size);
+			goto done;
+		}
+		out_free[i] = true;
+	}
+
+	for (i = 0; i < cap.count; i++) {
+		struct v4l2_buffer vb = {
+			.index = i,
+			.type = cap.type,
+			.memory = V4L2_MEMORY_MMAP,
+		};
+
+		if (queue_buffer(&cap, &vb))
+			goto done;
+	}
+
+	if (xioctl(out.fd, VIDIOC_STREAMON, &out.type) < 0 ||
+	    xioctl(cap.fd, VIDIOC_STREAMON, &cap.type) < 0) {
+		perror("VIDIOC_STREAMON");
+		goto done;
+	}
+
+	printf("%s -> %s: %ux%u %s %s%s, %.4s out, %u+%u buffers%s, %s kernel\n",
+	       cap.path, out.path, params.width, params.height,
+	       bayer_name(params.bayer),
+	       params.packed ? "RAW10 packed" : "RAW10 16-bit",
+	       params.rotate180 ? " rotated" : "",
+	       (char *)&out_fmt.pixelformat, cap.count, out.count,
+	       dmabuf ? " (dma-buf)" : "", convert_kernel_name(conv));
+	fflush(stdout);
+
+	stage_reset(stages);
+	period_start = now_us();
+
+	while (!stop && (!max_frames || frames < max_frames)) {
+		struct v4l2_buffer cvb = {
+			.type = cap.type,
+			.memory = V4L2_MEMORY_MMAP,
+		};
+		struct v4l2_buffer ovb = {
+			.type = out.type,
+			.memory = V4L2_MEMORY_MMAP,
+		};
+		struct pollfd pfd = { .fd = cap.fd, .events = POLLIN };
+		const struct stats *st = NULL;
+		double t_dq, t_conv, t_queue, t_frame;
+		unsigned int slot;
+
+		ret = poll(&pfd, 1, 1000);
+		if (ret <= 0) {
+			if (!ret)
+				fprintf(stderr, "%s: no frame for 1 s\n",
+					cap.path);
+			else if (errno != EINTR)
+				break;
+			continue;
+		}
+
+		if (xioctl(cap.fd, VIDIOC_DQBUF, &cvb) < 0) {
+			fprintf(stderr, "%s: VIDIOC_DQBUF: %s\n", cap.path,
+				strerror(errno));
+			break;
+		}
+		t_dq = now_us();
+
+		/* Reclaim an output buffer, waiting only if all are queued */
+		for (slot = 0; slot < out.count && !out_free[slot]; slot++)
+			;
+		if (slot == out.count) {
+			if (xioctl(out.fd, VIDIOC_DQBUF, &ovb) < 0) {
+				fprintf(stderr, "%s: VIDIOC_DQBUF: %s\n",
+					out.path, strerror(errno));
+				break;
+			}
+			slot = ovb.index;
+		}
+
+		if (cvb.flags & V4L2_BUF_FLAG_ERROR) {
+			errors++;
+			if (queue_buffer(&cap, &cvb))
+				break;
+			out_free[slot] = true;
+			continue;
+		}
+
+		dmabuf_sync(&cap.bufs[cvb.index], DMA_BUF_SYNC_START);
+		convert_frame(conv, cap.bufs[cvb.index].mem,
+			      out.bufs[slot].mem);
+		if (ae)
+			st = stats_frame(eng, cap.bufs[cvb.index].mem);
+		dmabuf_sync(&cap.bufs[cvb.index], DMA_BUF_SYNC_END);
+		t_conv = now_us();
+
+		ovb.index = slot;
+		ovb.bytesused = out_size;
+		ovb.field = V4L2_FIELD_NONE;
+		ovb.timestamp = cvb.timestamp;
+		if (queue_buffer(&out, &ovb) || queue_buffer(&cap, &cvb))
+			break;
+		out_free[slot] = false;
+		t_queue = now_us();
+
+		/* The control write goes over I2C; keep it off the frame path */
+		if (st) {
+			struct ae_setting next;
+			struct ae_status status;
+
+			if (ae_process(ae, cvb.sequence, st, &next, &status) &&
+			    subdev_set_exposure(subdev, next.exposure,
+						next.gain, ae_digital) < 0)
+				fprintf(stderr, "%s: VIDIOC_S_EXT_CTRLS: %s\n",
+					subdev_path, strerror(errno));
+		}
+
+		/*
+		 * The capture timestamp is the end of the frame on the
+		 * monotonic clock, when the driver says so; otherwise the
+		 * dequeue stage is unknown and counted from the dequeue.
+		 */
+		if ((cvb.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) ==
+		    V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+			t_frame = cvb.timestamp.tv_sec * 1e6 +
+				  cvb.timestamp.tv_usec;
+		else
+			t_frame = t_dq;
+
+		stage_add(&stages[STAGE_DEQUEUE], t_dq - t_frame);
+		stage_add(&stages[STAGE_CONVERT], t_conv - t_dq);
+		stage_add(&stages[STAGE_QUEUE], t_queue - t_conv);
+		stage_add(&stages[STAGE_TOTAL], t_queue - t_frame);
+		frames++;
+		period_frames++;
+
+		if (interval && t_queue - period_start >= interval * 1e6) {
+			stage_report(stages, period_frames,
+				     t_queue - period_start, errors);
+			stage_reset(stages);
+			period_start = t_queue;
+			period_frames = 0;
+			errors = 0;
+		}
+	}
+
+	if (interval && period_frames)
+		stage_report(stages, period_frames, now_us() - period_start,
+			     errors);
+
+	ret = stop || (max_frames && frames == max_frames) ? 0 : 1;
+done:
+	close_device(&cap);
+	close_device(&out);
+	convert_destroy(conv);
+	ae_destroy(ae);
+	stats_destroy(eng);
+	if (subdev >= 0)
+		close(subdev);
+	return ret;
+}
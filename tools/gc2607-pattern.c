@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-pattern - generate or check synthetic GC2607 test frames
+ *
+ * Writes synthetic GRBG10 frames as a fixed input for benchmarking and
+ * regression testing the conversion without the camera:
+ *   gc2607-pattern -n 30 bars bars.raw
+ *   gc2607-convert --bench bars.raw
+ * or checks that a RAW file, e.g. one passed through a pipeline stage,
+ * still holds the pattern bit for bit:
+ *   gc2607-pattern --check bars out.raw
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pattern.h"
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <pattern> <output.raw>\n"
+		"       %s --check [options] <pattern> <capture.raw>\n"
+		"\n"
+		"Patterns: bars, black, white, red, green, blue, pn9\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH        Frame size (default 1920x1080)\n"
+		"  -n, --frames N        Frames to write (default 1)\n"
+		"  -p, --packed          CSI-2 packed RAW10 (default 16-bit)\n"
+		"      --bayer ORDER     Bayer order of the output (default grbg)\n"
+		"  -c, --check           Compare every frame of a RAW file instead\n",
+		argv0, argv0);
+}
+
+/* CSI-2 RAW10: four 8-bit MSB bytes, then one byte of the 2-bit LSBs */
+static void pack10(const uint16_t *src, unsigned int count, uint8_t *dst)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i += 4, src += 4, dst += 5) {
+		dst[0] = src[0] >> 2;
+		dst[1] = src[1] >> 2;
+		dst[2] = src[2] >> 2;
+		dst[3] = src[3] >> 2;
+		dst[4] = (src[0] & 3) | (src[1] & 3) << 2 |
+			 (src[2] & 3) << 4 | (src[3] & 3) << 6;
+	}
+}
+
+/* Number of differing lines; the first is reported */
+static unsigned int check_frame(const uint8_t *got, const uint8_t *want,
+				size_t stride, unsigned int height,
+				unsigned int frame)
+{
+	unsigned int y, bad = 0;
+	size_t x;
+
+	for (y = 0; y < height; y++) {
+		const uint8_t *g = got + y * stride, *w = want + y * stride;
+
+		if (!memcmp(g, w, stride))
+			continue;
+
+		if (!bad) {
+			for (x = 0; g[x] == w[x]; x++)
+				;
+			printf("frame %u: first difference at line %u, byte %zu: 0x%02x, expected 0x%02x\n",
+			       frame, y, x, g[x], w[x]);
+		}
+		bad++;
+	}
+
+	return bad;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "frames", required_argument, NULL, 'n' },
+		{ "packed", no_argument, NULL, 'p' },
+		{ "bayer", required_argument, NULL, 'O' },
+		{ "check", no_argument, NULL, 'c' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	struct pattern_params params = {
+		.width = 1920,
+		.height = 1080,
+	};
+	unsigned int frames = 1, bad_frames = 0, f;
+	bool packed = false, check = false;
+	uint16_t *frame = NULL;
+	uint8_t *out = NULL;
+	size_t stride, size;
+	int ret = 1, opt;
+
+	while ((opt = getopt_long(argc, argv, "s:n:pch", long_opts,
+				  NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &params.width,
+				   &params.height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'n':
+			frames = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			packed = true;
+			break;
+		case 'O':
+			if (bayer_parse(optarg, &params.bayer)) {
+				fprintf(stderr, "Unknown Bayer order '%s'\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'c':
+			check = true;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != 2 || !frames) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (pattern_parse(argv[optind], &params.pattern)) {
+		fprintf(stderr, "Unknown pattern '%s'\n", argv[optind]);
+		return 1;
+	}
+
+	if (packed && params.width % 4) {
+		fprintf(stderr, "Packed RAW10 needs a width multiple of 4\n");
+		return 1;
+	}
+
+	stride = packed ? params.width / 4 * 5 : params.width * 2;
+	size = stride * params.height;
+	frame = malloc((size_t)params.width * params.height * sizeof(*frame));
+	out = packed ? malloc(size) : (uint8_t *)frame;
+	if (!frame || !out) {
+		perror("malloc");
+		goto done;
+	}
+
+	if (pattern_fill(&params, frame)) {
+		fprintf(stderr, "pattern_fill: %s\n", strerror(errno));
+		goto done;
+	}
+	if (packed)
+		pack10(frame, params.width * params.height, out);
+
+	if (check) {
+		const uint8_t *raw;
+		struct stat st;
+		int fd;
+
+		fd = open(argv[optind + 1], O_RDONLY);
+		if (fd < 0 || fstat(fd, &st) < 0) {
+			perror(argv[optind + 1]);
+			goto done;
+		}
+
+		frames = st.st_size / size;
+		if (!frames) {
+			fprintf(stderr, "%s: %lld bytes, less than one %ux%u frame (%zu bytes)\n",
+				argv[optind + 1], (long long)st.st_size,
+				params.width, params.height, size);
+			close(fd);
+			goto done;
+		}
+
+		raw = mmap(NULL, frames * size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (raw == MAP_FAILED) {
+			perror("mmap");
+			goto done;
+		}
+
+		for (f = 0; f < frames; f++)
+			if (check_frame(raw + f * size, out, stride,
+					params.height, f))
+				bad_frames++;
+		munmap((void *)raw, frames * size);
+
+		printf("%s %s: %u of %u frame(s) match\n",
+		       pattern_name(params.pattern), bayer_name(params.bayer),
+		       frames - bad_frames, frames);
+		ret = bad_frames ? 1 : 0;
+	} else {
+		FILE *fout = fopen(argv[optind + 1], "wb");
+
+		if (!fout) {
+			perror(argv[optind + 1]);
+			goto done;
+		}
+
+		for (f = 0; f < frames; f++) {
+			if (fwrite(out, size, 1, fout) != 1) {
+				perror(argv[optind + 1]);
+				fclose(fout);
+				goto done;
+			}
+		}
+
+		if (fclose(fout)) {
+			perror(argv[optind + 1]);
+			goto done;
+		}
+		ret = 0;
+	}
+
+done:
+	if (out != (uint8_t *)frame)
+		free(out);
+	free(frame);
+	return ret;
+}
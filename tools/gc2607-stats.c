@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * gc2607-stats - AE/AWB statistics of GC2607 raw captures
+ *
+ *   gc2607-stats cap.raw                 # channel means and gray world gains
+ *   gc2607-stats --grid cap.raw          # plus the zone grid
+ *   gc2607-stats --bench -x 2,2 cap.raw  # ms/frame, every second quad
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stats.h"
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <input.raw>\n"
+		"\n"
+		"Options:\n"
+		"  -s, --size WxH        Frame size (default 1920x1080)\n"
+		"  -z, --zones XxY       Zone grid (default 16x12)\n"
+		"  -x, --skip X,Y        Sample every Xth quad of every Yth quad row\n"
+		"      --bayer ORDER     grbg, rggb, bggr or gbrg (default grbg)\n"
+		"  -g, --grid            Print the green mean of every zone\n"
+		"      --bench           Report ms/frame instead of the statistics\n"
+		"  -i, --iterations N    Benchmark passes over the input (default 100)\n",
+		argv0);
+}
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Share of a channel's samples in the top histogram bin */
+static double clipped(const struct stats *st, enum stats_channel ch)
+{
+	return st->quads ? 100.0 * st->hist[ch][STATS_BINS - 1] / st->quads : 0;
+}
+
+static void print_stats(const struct stats *st, bool grid)
+{
+	static const char *const names[] = { "Gr", "R", "B", "Gb" };
+	double g = (stats_mean(st, STATS_GR) + stats_mean(st, STATS_GB)) / 2;
+	double r = stats_mean(st, STATS_R), b = stats_mean(st, STATS_B);
+	unsigned int ch, zx, zy;
+
+	printf("%u quads sampled\n\n", st->quads);
+	printf("Channel    mean  clipped\n");
+	for (ch = 0; ch < STATS_CHANNELS; ch++)
+		printf("  %-4s %8.1f %7.2f%%\n", names[ch], stats_mean(st, ch),
+		       clipped(st, ch));
+
+	printf("\nGray world gains: R=%.3f G=1.000 B=%.3f\n",
+	       r > 0 ? g / r : 1.0, b > 0 ? g / b : 1.0);
+
+	if (!grid)
+		return;
+
+	printf("\nZone green means (%ux%u):\n", st->zones_x, st->zones_y);
+	for (zy = 0; zy < st->zones_y; zy++) {
+		for (zx = 0; zx < st->zones_x; zx++)
+			printf(" %4.0f", (stats_zone_mean(st, zx, zy, STATS_GR) +
+					  stats_zone_mean(st, zx, zy, STATS_GB)) / 2);
+		printf("\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_opts[] = {
+		{ "size", required_argument, NULL, 's' },
+		{ "zones", required_argument, NULL, 'z' },
+		{ "skip", required_argument, NULL, 'x' },
+		{ "bayer", required_argument, NULL, 'O' },
+		{ "grid", no_argument, NULL, 'g' },
+		{ "bench", no_argument, NULL, 'B' },
+		{ "iterations", required_argument, NULL, 'i' },
+		{ "help", no_argument, NULL, 'h' },
+		{ }
+	};
+	struct stats_params params = {
+		.width = 1920,
+		.height = 1080,
+	};
+	unsigned int iterations = 100, frames, i, f;
+	bool bench = false, grid = false;
+	struct stats_engine *eng;
+	const struct stats *st;
+	size_t frame_size;
+	struct stat sb;
+	uint8_t *raw;
+	int fd, opt;
+
+	while ((opt = getopt_long(argc, argv, "s:z:x:gi:h", long_opts,
+				  NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (sscanf(optarg, "%ux%u", &params.width,
+				   &params.height) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'z':
+			if (sscanf(optarg, "%ux%u", &params.zones_x,
+				   &params.zones_y) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'x':
+			if (sscanf(optarg, "%u,%u", &params.skip_x,
+				   &params.skip_y) != 2) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'O':
+			if (bayer_parse(optarg, &params.bayer)) {
+				fprintf(stderr, "Unknown Bayer order '%s'\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'g':
+			grid = true;
+			break;
+		case 'B':
+			bench = true;
+			break;
+		case 'i':
+			iterations = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (argc - optind != 1 || !iterations) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	fd = open(argv[optind], O_RDONLY);
+	if (fd < 0 || fstat(fd, &sb) < 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	frame_size = (size_t)params.width * params.height * 2;
+	frames = sb.st_size / frame_size;
+	if (!frames) {
+		fprintf(stderr, "%s: %lld bytes, less than one %ux%u frame (%zu bytes)\n",
+			argv[optind], (long long)sb.st_size, params.width,
+			params.height, frame_size);
+		return 1;
+	}
+
+	raw = mmap(NULL, frames * frame_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (raw == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	eng = stats_create(&params);
+	if (!eng) {
+		fprintf(stderr, "stats_create: %s\n", strerror(errno));
+		return 1;
+	}
+
+	if (bench) {
+		double total = 0, best = 1e9;
+
+		/* Untimed pass to fault in the input */
+		for (f = 0; f < frames; f++)
+			stats_frame(eng, raw + f * frame_size);
+
+		for (i = 0; i < iterations; i++) {
+			for (f = 0; f < frames; f++) {
+				double start = now_ms(), ms;
+
+				stats_frame(eng, raw + f * frame_size);
+				ms = now_ms() - start;
+				total += ms;
+				if (ms < best)
+					best = ms;
+			}
+		}
+
+		printf("%ux%u, %u frame(s) x %u iterations: %.3f ms/frame avg %.3f ms/frame min\n",
+		       params.width, params.height, frames, iterations,
+		       total / (iterations * frames), best);
+	} else {
+		st = stats_frame(eng, raw);
+		print_stats(st, grid);
+	}
+
+	stats_destroy(eng);
+	munmap(raw, frames * frame_size);
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Synthetic GC2607 test frames
+ *
+ * Every pattern is defined on a GRBG array, in raster order from the top
+ * left of the output window. Any other output order is produced by
+ * mirroring that array: for even sizes, mirroring moves GRBG by one pixel
+ * per axis, so each order maps to a horizontal and vertical mirror.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "pattern.h"
+
+#define PATTERN_MAX		1023
+#define PATTERN_BARS_COUNT	8
+
+static const char *const pattern_names[] = {
+	[PATTERN_BARS] = "bars",
+	[PATTERN_BLACK] = "black",
+	[PATTERN_WHITE] = "white",
+	[PATTERN_RED] = "red",
+	[PATTERN_GREEN] = "green",
+	[PATTERN_BLUE] = "blue",
+	[PATTERN_PN9] = "pn9",
+};
+
+/* Bit 0 red, bit 1 green, bit 2 blue */
+#define RGB(r, g, b)	((r) | (g) << 1 | (b) << 2)
+
+static const uint8_t bar_colours[PATTERN_BARS_COUNT] = {
+	RGB(1, 1, 1), RGB(1, 1, 0), RGB(0, 1, 1), RGB(0, 1, 0),
+	RGB(1, 0, 1), RGB(1, 0, 0), RGB(0, 0, 1), RGB(0, 0, 0),
+};
+
+int pattern_parse(const char *name, enum pattern *pattern)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(pattern_names) / sizeof(pattern_names[0]); i++) {
+		if (!strcmp(name, pattern_names[i])) {
+			*pattern = i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+const char *pattern_name(enum pattern pattern)
+{
+	return pattern_names[pattern];
+}
+
+/* Colour bit each GRBG quad position samples: G R / B G */
+static const uint8_t grbg_bit[4] = { 2, 1, 4, 2 };
+
+static uint16_t solid_value(uint8_t colour, unsigned int x, unsigned int y)
+{
+	return colour & grbg_bit[(y & 1) * 2 + (x & 1)] ? PATTERN_MAX : 0;
+}
+
+int pattern_fill(const struct pattern_params *p, uint16_t *frame)
+{
+	unsigned int width = p->width, height = p->height;
+	unsigned int hflip = BAYER_DX(p->bayer), vflip = BAYER_DY(p->bayer);
+	unsigned int pn9 = 0x1ff, colour = 0, x, y;
+
+	if (!width || !height || width % 2 || height % 2) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	switch (p->pattern) {
+	case PATTERN_BLACK:
+		colour = RGB(0, 0, 0);
+		break;
+	case PATTERN_WHITE:
+		colour = RGB(1, 1, 1);
+		break;
+	case PATTERN_RED:
+		colour = RGB(1, 0, 0);
+		break;
+	case PATTERN_GREEN:
+		colour = RGB(0, 1, 0);
+		break;
+	case PATTERN_BLUE:
+		colour = RGB(0, 0, 1);
+		break;
+	case PATTERN_BARS:
+	case PATTERN_PN9:
+		break;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (y = 0; y < height; y++) {
+		uint16_t *row = frame + (size_t)(vflip ? height - 1 - y : y) *
+					width;
+
+		for (x = 0; x < width; x++) {
+			uint16_t v;
+
+			if (p->pattern == PATTERN_PN9) {
+				pn9 = (pn9 << 1 | ((pn9 >> 8 ^ pn9 >> 4) & 1)) &
+				      0x1ff;
+				v = pn9 << 1;
+			} else if (p->pattern == PATTERN_BARS) {
+				v = solid_value(bar_colours[x * PATTERN_BARS_COUNT /
+							    width], x, y);
+			} else {
+				v = solid_value(colour, x, y);
+			}
+
+			row[hflip ? width - 1 - x : x] = v;
+		}
+	}
+
+	return 0;
+}
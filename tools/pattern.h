@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Synthetic GC2607 test frames
+ *
+ * Fixed GRBG10 input for benchmarking and regression testing the conversion
+ * and loopback stages without the camera. This is not a model of the
+ * sensor's own pattern generator, whose registers are not known. The
+ * patterns are drawn on a GRBG array and mirrored into the requested
+ * output Bayer order (see bayer.h).
+ */
+#ifndef GC2607_PATTERN_H
+#define GC2607_PATTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bayer.h"
+
+enum pattern {
+	PATTERN_BARS,		/* White, yellow, cyan, green, magenta, red, blue, black */
+	PATTERN_BLACK,
+	PATTERN_WHITE,
+	PATTERN_RED,
+	PATTERN_GREEN,
+	PATTERN_BLUE,
+	PATTERN_PN9,		/* x^9 + x^5 + 1 from 0x1ff, one step per pixel */
+};
+
+struct pattern_params {
+	enum pattern pattern;
+	unsigned int width;		/* Even, in pixels */
+	unsigned int height;		/* Even, in lines */
+	enum bayer_order bayer;		/* Bayer order of the output frame */
+};
+
+/* Fill one 16-bit RAW10 frame of width * height samples */
+int pattern_fill(const struct pattern_params *params, uint16_t *frame);
+
+int pattern_parse(const char *name, enum pattern *pattern);
+const char *pattern_name(enum pattern pattern);
+
+#endif /* GC2607_PATTERN_H */
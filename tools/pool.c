@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Work-stealing thread pool for frame stripes
+ *
+ * Each worker owns a range of job indices packed into one 64-bit word,
+ * head in the low half and tail in the high half. The owner advances the
+ * head and thieves retreat the tail, both with a compare-and-swap on the
+ * whole word, so a job is handed out exactly once without locks. The
+ * mutex and condition variables are only used to start a run and to
+ * report that the last job has finished.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+#define POOL_MAX_THREADS	64
+
+struct pool_queue {
+	_Alignas(64) _Atomic uint64_t range;
+};
+
+struct pool_worker {
+	struct pool *pool;
+	unsigned int id;
+	pthread_t thread;
+};
+
+struct pool {
+	unsigned int threads;
+	struct pool_queue queues[POOL_MAX_THREADS];
+	struct pool_worker workers[POOL_MAX_THREADS];
+
+	pool_fn fn;
+	void *ctx;
+	_Atomic unsigned int remaining;
+
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	unsigned long generation;
+	bool quit;
+};
+
+static inline uint64_t make_range(uint32_t head, uint32_t tail)
+{
+	return (uint64_t)tail << 32 | head;
+}
+
+/* Next job from the front of the worker's own range, or -1 */
+static int take_front(struct pool_queue *q)
+{
+	uint64_t r = atomic_load(&q->range);
+
+	for (;;) {
+		uint32_t head = r, tail = r >> 32;
+
+		if (head >= tail)
+			return -1;
+		if (atomic_compare_exchange_weak(&q->range, &r,
+						 make_range(head + 1, tail)))
+			return head;
+	}
+}
+
+/* Last job of another worker's range, or -1 */
+static int steal_back(struct pool_queue *q)
+{
+	uint64_t r = atomic_load(&q->range);
+
+	for (;;) {
+		uint32_t head = r, tail = r >> 32;
+
+		if (head >= tail)
+			return -1;
+		if (atomic_compare_exchange_weak(&q->range, &r,
+						 make_range(head, tail - 1)))
+			return tail - 1;
+	}
+}
+
+/* Steal from the worker with the most jobs left */
+static int steal(struct pool *pool, unsigned int self)
+{
+	for (;;) {
+		unsigned int i, victim = self, most = 0;
+		int job;
+
+		for (i = 0; i < pool->threads; i++) {
+			uint64_t r = atomic_load(&pool->queues[i].range);
+			uint32_t head = r, tail = r >> 32;
+
+			if (i != self && tail > head && tail - head > most) {
+				most = tail - head;
+				victim = i;
+			}
+		}
+
+		if (!most)
+			return -1;
+
+		/* Lost a race for the victim's last job: look again */
+		job = steal_back(&pool->queues[victim]);
+		if (job >= 0)
+			return job;
+	}
+}
+
+static void finish_job(struct pool *pool)
+{
+	if (atomic_fetch_sub(&pool->remaining, 1) == 1) {
+		pthread_mutex_lock(&pool->lock);
+		pthread_cond_broadcast(&pool->done);
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+static void work(struct pool *pool, unsigned int self)
+{
+	int job;
+
+	while ((job = take_front(&pool->queues[self])) >= 0) {
+		pool->fn(pool->ctx, job, self);
+		finish_job(pool);
+	}
+
+	while ((job = steal(pool, self)) >= 0) {
+		pool->fn(pool->ctx, job, self);
+		finish_job(pool);
+	}
+}
+
+static void *worker_main(void *arg)
+{
+	struct pool_worker *w = arg;
+	struct pool *pool = w->pool;
+	unsigned long seen = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (!pool->quit && pool->generation == seen)
+			pthread_cond_wait(&pool->start, &pool->lock);
+		seen = pool->generation;
+		if (pool->quit) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&pool->lock);
+
+		work(pool, w->id);
+	}
+}
+
+struct pool *pool_create(unsigned int threads)
+{
+	struct pool *pool;
+	unsigned int i;
+
+	if (!threads) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+		threads = cpus > 0 ? cpus : 1;
+	}
+	if (threads > POOL_MAX_THREADS)
+		threads = POOL_MAX_THREADS;
+
+	pool = calloc(1, sizeof(*pool));
+	if (!pool)
+		return NULL;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+
+	/* Worker 0 is whoever calls pool_run() */
+	pool->threads = 1;
+	for (i = 1; i < threads; i++) {
+		struct pool_worker *w = &pool->workers[i];
+
+		w->pool = pool;
+		w->id = i;
+		if (pthread_create(&w->thread, NULL, worker_main, w))
+			break;
+		pool->threads++;
+	}
+
+	return pool;
+}
+
+void pool_destroy(struct pool *pool)
+{
+	unsigned int i;
+
+	if (!pool)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	pool->quit = true;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (i = 1; i < pool->threads; i++)
+		pthread_join(pool->workers[i].thread, NULL);
+
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->start);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool);
+}
+
+unsigned int pool_threads(const struct pool *pool)
+{
+	return pool->threads;
+}
+
+void pool_run(struct pool *pool, unsigned int jobs, pool_fn fn, void *ctx)
+{
+	unsigned int i, n = pool->threads;
+
+	if (!jobs)
+		return;
+
+	pool->fn = fn;
+	pool->ctx = ctx;
+	atomic_store(&pool->remaining, jobs);
+
+	/* Contiguous ranges keep each worker's stripes, and halos, adjacent */
+	for (i = 0; i < n; i++)
+		atomic_store(&pool->queues[i].range,
+			     make_range((uint64_t)jobs * i / n,
+					(uint64_t)jobs * (i + 1) / n));
+
+	if (n > 1) {
+		pthread_mutex_lock(&pool->lock);
+		pool->generation++;
+		pthread_cond_broadcast(&pool->start);
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	work(pool, 0);
+
+	pthread_mutex_lock(&pool->lock);
+	while (atomic_load(&pool->remaining))
+		pthread_cond_wait(&pool->done, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Work-stealing thread pool for frame stripes
+ *
+ * pool_run() splits jobs 0..n-1 into one contiguous range per worker.
+ * A worker takes jobs from the front of its own range; once that is
+ * empty it steals from the back of the fullest other range, so uneven
+ * stripes or a descheduled thread do not stall the frame. The calling
+ * thread is worker 0, so a pool of one thread runs everything inline.
+ */
+#ifndef GC2607_POOL_H
+#define GC2607_POOL_H
+
+typedef void (*pool_fn)(void *ctx, unsigned int job, unsigned int worker);
+
+struct pool;
+
+/* @threads of 0 uses one per online CPU */
+struct pool *pool_create(unsigned int threads);
+void pool_destroy(struct pool *pool);
+
+unsigned int pool_threads(const struct pool *pool);
+
+/* Run @fn for every job in 0..@jobs-1 and wait for all of them */
+void pool_run(struct pool *pool, unsigned int jobs, pool_fn fn, void *ctx);
+
+#endif /* GC2607_POOL_H */
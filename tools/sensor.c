@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * GC2607 subdev controls as seen from userspace
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+
+#include <linux/v4l2-controls.h>
+#include <linux/videodev2.h>
+
+#include "sensor.h"
+
+int subdev_open(const char *path)
+{
+	int fd = open(path, O_RDWR);
+
+	if (fd < 0)
+		perror(path);
+
+	return fd;
+}
+
+int subdev_get_range(int fd, unsigned int id, int *min, int *max, int *value)
+{
+	struct v4l2_queryctrl qc = { .id = id };
+	struct v4l2_control ctrl = { .id = id };
+
+	if (ioctl(fd, VIDIOC_QUERYCTRL, &qc) < 0 ||
+	    ioctl(fd, VIDIOC_G_CTRL, &ctrl) < 0)
+		return -1;
+
+	*min = qc.minimum;
+	*max = qc.maximum;
+	*value = ctrl.value;
+	return 0;
+}
+
+int subdev_set_exposure(int fd, unsigned int exposure, unsigned int gain,
+			bool digital)
+{
+	unsigned int again = gain < GC2607_GAIN_MAX ? gain : GC2607_GAIN_MAX;
+	struct v4l2_ext_control ctrl[3] = {
+		{ .id = V4L2_CID_EXPOSURE, .value = exposure },
+		{ .id = V4L2_CID_ANALOGUE_GAIN, .value = again },
+		{
+			.id = V4L2_CID_DIGITAL_GAIN,
+			.value = (gain * GC2607_GAIN_UNIT + again / 2) / again,
+		},
+	};
+	struct v4l2_ext_controls ctrls = {
+		.which = V4L2_CTRL_WHICH_CUR_VAL,
+		.count = digital ? 3 : 2,
+		.controls = ctrl,
+	};
+
+	return ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+}
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * GC2607 subdev controls as seen from userspace
+ */
+#ifndef GC2607_SENSOR_H
+#define GC2607_SENSOR_H
+
+#include <stdbool.h>
+
+/* V4L2_CID_ANALOGUE_GAIN is linear in 1/64 units, up to the top LUT entry */
+#define GC2607_GAIN_UNIT	64
+#define GC2607_GAIN_MIN		64
+#define GC2607_GAIN_MAX		1012
+
+/* V4L2_CID_DIGITAL_GAIN multiplies on top of it, in the same units */
+#define GC2607_DGAIN_MAX	256
+
+int subdev_open(const char *path);
+int subdev_get_range(int fd, unsigned int id, int *min, int *max, int *value);
+
+/*
+ * Write exposure and gain in one VIDIOC_S_EXT_CTRLS. With @digital, the
+ * part of @gain above GC2607_GAIN_MAX goes to V4L2_CID_DIGITAL_GAIN.
+ */
+int subdev_set_exposure(int fd, unsigned int exposure, unsigned int gain,
+			bool digital);
+
+#endif /* GC2607_SENSOR_H */
@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Per-frame Bayer RAW10 statistics for AE and AWB
+ *
+ * The frame is walked one quad row (two raw lines) at a time. While the
+ * two lines are in L1, the per-zone channel sums are taken span by span
+ * with a vectorised reduction, then the four histograms are updated in a
+ * second loop over the same lines. Histogram updates are scatter stores
+ * that do not vectorise; keeping them out of the sum loop is what lets
+ * the sums run at SIMD width.
+ *
+ * The loops accumulate by position in the quad. For Bayer orders other
+ * than GRBG the positions are swapped into channels once at the end.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+#define STATS_MAX		1023
+#define STATS_DEFAULT_ZONES_X	16
+#define STATS_DEFAULT_ZONES_Y	12
+
+/* Pick the best of these at load time on x86 */
+#if defined(__x86_64__) || defined(__i386__)
+#define STATS_SIMD	__attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+#define STATS_SIMD
+#endif
+
+struct stats_engine {
+	struct stats_params p;
+	struct stats st;
+	unsigned int half;		/* Quads per row */
+
+	/* First quad column of each zone column, plus the row end */
+	unsigned int zone_col[STATS_MAX_ZONES_X + 1];
+};
+
+/* Channel sums of @n consecutive quads */
+STATS_SIMD
+static void sum_quads(const uint16_t *restrict r0, const uint16_t *restrict r1,
+		      unsigned int n, uint32_t *acc)
+{
+	uint32_t gr = 0, r = 0, b = 0, gb = 0;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		gr += r0[2 * i] & STATS_MAX;
+		r += r0[2 * i + 1] & STATS_MAX;
+		b += r1[2 * i] & STATS_MAX;
+		gb += r1[2 * i + 1] & STATS_MAX;
+	}
+
+	acc[STATS_GR] += gr;
+	acc[STATS_R] += r;
+	acc[STATS_B] += b;
+	acc[STATS_GB] += gb;
+}
+
+/* Channel sums of @n quads, @step quads apart */
+static void sum_quads_step(const uint16_t *r0, const uint16_t *r1,
+			   unsigned int n, unsigned int step, uint32_t *acc)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++, r0 += 2 * step, r1 += 2 * step) {
+		acc[STATS_GR] += r0[0] & STATS_MAX;
+		acc[STATS_R] += r0[1] & STATS_MAX;
+		acc[STATS_B] += r1[0] & STATS_MAX;
+		acc[STATS_GB] += r1[1] & STATS_MAX;
+	}
+}
+
+static void hist_quads(struct stats *st, const uint16_t *r0,
+		       const uint16_t *r1, unsigned int half, unsigned int step)
+{
+	uint32_t *gr = st->hist[STATS_GR], *r = st->hist[STATS_R];
+	uint32_t *b = st->hist[STATS_B], *gb = st->hist[STATS_GB];
+	unsigned int i;
+
+	/* Four tables, so consecutive increments rarely hit the same bin */
+	for (i = 0; i < half; i += step) {
+		gr[(r0[2 * i] & STATS_MAX) >> 2]++;
+		r[(r0[2 * i + 1] & STATS_MAX) >> 2]++;
+		b[(r1[2 * i] & STATS_MAX) >> 2]++;
+		gb[(r1[2 * i + 1] & STATS_MAX) >> 2]++;
+	}
+}
+
+struct stats_engine *stats_create(const struct stats_params *params)
+{
+	struct stats_engine *eng;
+	unsigned int zones, i;
+
+	eng = calloc(1, sizeof(*eng));
+	if (!eng)
+		return NULL;
+
+	eng->p = *params;
+	if (!eng->p.stride)
+		eng->p.stride = eng->p.width * 2;
+	if (!eng->p.zones_x || !eng->p.zones_y) {
+		eng->p.zones_x = STATS_DEFAULT_ZONES_X;
+		eng->p.zones_y = STATS_DEFAULT_ZONES_Y;
+	}
+	if (!eng->p.skip_x)
+		eng->p.skip_x = 1;
+	if (!eng->p.skip_y)
+		eng->p.skip_y = 1;
+
+	eng->half = eng->p.width / 2;
+	if (!eng->p.width || !eng->p.height || eng->p.width % 2 ||
+	    eng->p.height % 2 || eng->p.zones_x > STATS_MAX_ZONES_X ||
+	    eng->p.zones_y > STATS_MAX_ZONES_Y ||
+	    eng->p.zones_x > eng->half / eng->p.skip_x ||
+	    eng->p.zones_y > eng->p.height / 2 / eng->p.skip_y) {
+		errno = EINVAL;
+		goto err;
+	}
+
+	zones = eng->p.zones_x * eng->p.zones_y;
+	eng->st.zones_x = eng->p.zones_x;
+	eng->st.zones_y = eng->p.zones_y;
+	eng->st.zone_sum = calloc(zones, sizeof(*eng->st.zone_sum));
+	eng->st.zone_quads = calloc(zones, sizeof(*eng->st.zone_quads));
+	if (!eng->st.zone_sum || !eng->st.zone_quads)
+		goto err;
+
+	/* Zone edges on the sampling grid, so every zone gets whole steps */
+	for (i = 0; i <= eng->p.zones_x; i++) {
+		unsigned int steps = eng->half / eng->p.skip_x;
+
+		eng->zone_col[i] = steps * i / eng->p.zones_x * eng->p.skip_x;
+	}
+	eng->zone_col[eng->p.zones_x] = eng->half;
+
+	return eng;
+
+err:
+	stats_destroy(eng);
+	return NULL;
+}
+
+void stats_destroy(struct stats_engine *eng)
+{
+	if (!eng)
+		return;
+
+	free(eng->st.zone_sum);
+	free(eng->st.zone_quads);
+	free(eng);
+}
+
+/* Quad position @pos holds channel pos ^ order; swap each pair once */
+static void remap_channels(struct stats *st, unsigned int zones,
+			   enum bayer_order order)
+{
+	uint32_t hist[STATS_BINS], v;
+	unsigned int pos, ch, z;
+
+	for (pos = 0; pos < STATS_CHANNELS; pos++) {
+		ch = pos ^ order;
+		if (ch <= pos)
+			continue;
+
+		memcpy(hist, st->hist[pos], sizeof(hist));
+		memcpy(st->hist[pos], st->hist[ch], sizeof(hist));
+		memcpy(st->hist[ch], hist, sizeof(hist));
+
+		for (z = 0; z < zones; z++) {
+			v = st->zone_sum[z][pos];
+			st->zone_sum[z][pos] = st->zone_sum[z][ch];
+			st->zone_sum[z][ch] = v;
+		}
+	}
+}
+
+const struct stats *stats_frame(struct stats_engine *eng, const void *raw)
+{
+	const struct stats_params *p = &eng->p;
+	unsigned int rows = p->height / 2, zones = p->zones_x * p->zones_y;
+	struct stats *st = &eng->st;
+	unsigned int qy, zx, zy, ch;
+
+	st->quads = 0;
+	for (ch = 0; ch < STATS_CHANNELS; ch++) {
+		st->sum[ch] = 0;
+		for (zx = 0; zx < STATS_BINS; zx++)
+			st->hist[ch][zx] = 0;
+	}
+	for (zx = 0; zx < zones; zx++) {
+		for (ch = 0; ch < STATS_CHANNELS; ch++)
+			st->zone_sum[zx][ch] = 0;
+		st->zone_quads[zx] = 0;
+	}
+
+	for (qy = 0; qy < rows; qy += p->skip_y) {
+		const uint16_t *r0 = (const uint16_t *)((const uint8_t *)raw +
+							2 * qy * p->stride);
+		const uint16_t *r1 = (const uint16_t *)((const uint8_t *)r0 +
+							p->stride);
+		unsigned int row_zone = (qy / p->skip_y) * p->zones_y /
+					((rows + p->skip_y - 1) / p->skip_y) *
+					p->zones_x;
+
+		for (zx = 0; zx < p->zones_x; zx++) {
+			unsigned int start = eng->zone_col[zx];
+			unsigned int end = eng->zone_col[zx + 1];
+			unsigned int n = (end - start + p->skip_x - 1) / p->skip_x;
+
+			if (p->skip_x == 1)
+				sum_quads(r0 + 2 * start, r1 + 2 * start, n,
+					  st->zone_sum[row_zone + zx]);
+			else
+				sum_quads_step(r0 + 2 * start, r1 + 2 * start,
+					       n, p->skip_x,
+					       st->zone_sum[row_zone + zx]);
+			st->zone_quads[row_zone + zx] += n;
+		}
+
+		hist_quads(st, r0, r1, eng->half, p->skip_x);
+	}
+
+	if (p->bayer != BAYER_GRBG)
+		remap_channels(st, zones, p->bayer);
+
+	for (zy = 0; zy < zones; zy++) {
+		for (ch = 0; ch < STATS_CHANNELS; ch++)
+			st->sum[ch] += st->zone_sum[zy][ch];
+		st->quads += st->zone_quads[zy];
+	}
+
+	return st;
+}
+
+double stats_mean(const struct stats *st, enum stats_channel ch)
+{
+	return st->quads ? (double)st->sum[ch] / st->quads : 0;
+}
+
+double stats_zone_mean(const struct stats *st, unsigned int zx,
+		       unsigned int zy, enum stats_channel ch)
+{
+	unsigned int z = zy * st->zones_x + zx;
+
+	return st->zone_quads[z] ?
+	       (double)st->zone_sum[z][ch] / st->zone_quads[z] : 0;
+}
@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Per-frame Bayer RAW10 statistics for AE and AWB
+ *
+ * One pass over the raw frame produces, per Bayer channel, the sum of
+ * the sampled pixels, a 256-bin histogram and the sums over a grid of
+ * zones. Everything is integer and the result buffers are allocated once
+ * at create time, so it can run on every frame of a live 3A loop.
+ */
+#ifndef GC2607_STATS_H
+#define GC2607_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bayer.h"
+
+enum stats_channel {
+	STATS_GR,		/* G on the R rows */
+	STATS_R,
+	STATS_B,
+	STATS_GB,		/* G on the B rows */
+	STATS_CHANNELS,
+};
+
+#define STATS_BINS		256
+#define STATS_MAX_ZONES_X	64
+#define STATS_MAX_ZONES_Y	64
+
+struct stats_params {
+	unsigned int width;		/* Even, in pixels */
+	unsigned int height;		/* Even, in lines */
+	size_t stride;			/* Bytes per raw line, 0 = width * 2 */
+	unsigned int zones_x;		/* Zone grid, 0 = 16x12 */
+	unsigned int zones_y;
+	unsigned int skip_x;		/* Sample every Nth 2x2 quad, 0 = 1 */
+	unsigned int skip_y;		/* Sample every Nth quad row, 0 = 1 */
+	enum bayer_order bayer;		/* Channels are reported as named */
+};
+
+struct stats {
+	unsigned int zones_x, zones_y;
+	uint32_t quads;			/* Quads sampled per channel */
+	uint64_t sum[STATS_CHANNELS];
+	uint32_t hist[STATS_CHANNELS][STATS_BINS];	/* value >> 2 */
+
+	/* zones_x * zones_y entries, row major */
+	uint32_t (*zone_sum)[STATS_CHANNELS];
+	uint32_t *zone_quads;
+};
+
+struct stats_engine;
+
+struct stats_engine *stats_create(const struct stats_params *params);
+void stats_destroy(struct stats_engine *eng);
+
+/* Gather statistics of one 16-bit RAW10 frame; valid until the next call */
+const struct stats *stats_frame(struct stats_engine *eng, const void *raw);
+
+/* Mean of a channel, or of one zone's channel, in 10-bit units */
+double stats_mean(const struct stats *st, enum stats_channel ch);
+double stats_zone_mean(const struct stats *st, unsigned int zx,
+		       unsigned int zy, enum stats_channel ch);
+
+#endif /* GC2607_STATS_H */
@@ -5,16 +5,18 @@
 set -e
 
 if [ "$#" -ne 2 ]; then
-    echo "Usage: $0 <exposure> <gain_index>"
+    echo "Usage: $0 <exposure> <gain>"
     echo ""
     echo "Current values:"
     v4l2-ctl -d /dev/v4l-subdev6 --list-ctrls | grep -E "(exposure|analogue_gain)"
     echo ""
     echo "Suggested starting points to try:"
-    echo "  $0 800 4   # Medium exposure, moderate gain"
-    echo "  $0 500 6   # Lower exposure, slightly higher gain"
-    echo "  $0 1000 2  # Higher exposure, low gain (cleaner)"
-    echo "  $0 400 8   # Low exposure, higher gain (more noise but better range)"
+    echo "  $0 800 130   # Medium exposure, moderate gain (2.0x)"
+    echo "  $0 500 184   # Lower exposure, slightly higher gain (2.9x)"
+    echo "  $0 1000 93   # Higher exposure, low gain (1.45x, cleaner)"
+    echo "  $0 400 253   # Low exposure, higher gain (4.0x, more noise but better range)"
+    echo ""
+    echo "Gain is linear in 1/64 units: 64 = 1.0x, 1012 = 15.8x (max)"
     echo ""
     echo "Tips:"
     echo "  - Lower exposure = less motion blur, need higher gain"
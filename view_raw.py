@@ -1,25 +1,19 @@
 #!/usr/bin/env python3
-"""Convert raw Bayer GRBG10 image to viewable PNG"""
+"""Convert raw Bayer 10-bit image to viewable PNG"""
 
 import numpy as np
 import sys
 from pathlib import Path
 
-def bayer_to_rgb_simple(bayer, width, height):
+from raw_bayer import bayer_arg, split_channels
+
+def bayer_to_rgb_simple(bayer, width, height, order='grbg'):
     """Simple Bayer to RGB conversion (2x2 downsampling)"""
     # Reshape to 2D array
     img = bayer.reshape(height, width)
 
     # Extract R, G, B channels (simple 2x2 demosaicing)
-    # GRBG pattern:
-    # G R G R
-    # B G B G
-    h2, w2 = height // 2, width // 2
-
-    r = img[0::2, 1::2][:h2, :w2]  # R channel
-    g1 = img[0::2, 0::2][:h2, :w2]  # G channel (first)
-    g2 = img[1::2, 1::2][:h2, :w2]  # G channel (second)
-    b = img[1::2, 0::2][:h2, :w2]  # B channel
+    r, g1, g2, b = split_channels(img, order)
 
     g = (g1.astype(np.float32) + g2.astype(np.float32)) / 2
 
@@ -31,7 +25,7 @@ def bayer_to_rgb_simple(bayer, width, height):
 
     return rgb
 
-def convert_raw_to_png(raw_file, width=1920, height=1080, bits=10):
+def convert_raw_to_png(raw_file, width=1920, height=1080, bits=10, order='grbg'):
     """Convert raw Bayer file to PNG"""
 
     # Read raw file
@@ -52,8 +46,8 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, bits=10):
         data = data[:expected_size]
 
     # Convert to RGB
-    print("Converting Bayer to RGB...")
-    rgb = bayer_to_rgb_simple(data, width, height)
+    print(f"Converting Bayer {order.upper()} to RGB...")
+    rgb = bayer_to_rgb_simple(data, width, height, order)
 
     # Save as PNG
     output = Path(raw_file).with_suffix('.png')
@@ -74,13 +68,15 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, bits=10):
         return False
 
 if __name__ == "__main__":
+    order = bayer_arg(sys.argv)
     if len(sys.argv) < 2:
-        print("Usage: ./view_raw.py <raw_file> [width] [height]")
+        print("Usage: ./view_raw.py [--bayer ORDER] <raw_file> [width] [height]")
         print("Example: ./view_raw.py test.raw 1920 1080")
+        print("ORDER defaults to the sensor's current one, else grbg")
         sys.exit(1)
 
     raw_file = sys.argv[1]
     width = int(sys.argv[2]) if len(sys.argv) > 2 else 1920
     height = int(sys.argv[3]) if len(sys.argv) > 3 else 1080
 
-    convert_raw_to_png(raw_file, width, height)
+    convert_raw_to_png(raw_file, width, height, order=order)
@@ -1,22 +1,19 @@
 #!/usr/bin/env python3
-"""Convert raw Bayer GRBG10 image to viewable PNG with brightness boost"""
+"""Convert raw Bayer 10-bit image to viewable PNG with brightness boost"""
 
 import numpy as np
 import sys
 from pathlib import Path
 
-def bayer_to_rgb_simple(bayer, width, height, brightness=3.0):
+from raw_bayer import bayer_arg, needs_rotation, split_channels
+
+def bayer_to_rgb_simple(bayer, width, height, brightness=3.0, order='grbg'):
     """Simple Bayer to RGB conversion with brightness adjustment"""
     # Reshape to 2D array
     img = bayer.reshape(height, width)
 
-    # Extract R, G, B channels (GRBG pattern)
-    h2, w2 = height // 2, width // 2
-
-    g1 = img[0::2, 0::2][:h2, :w2]  # G channel (first)
-    r = img[0::2, 1::2][:h2, :w2]   # R channel
-    b = img[1::2, 0::2][:h2, :w2]   # B channel
-    g2 = img[1::2, 1::2][:h2, :w2]  # G channel (second)
+    # Extract R, G, B channels
+    r, g1, g2, b = split_channels(img, order)
 
     g = (g1.astype(np.float32) + g2.astype(np.float32)) / 2
 
@@ -26,12 +23,14 @@ def bayer_to_rgb_simple(bayer, width, height, brightness=3.0):
     # Apply brightness boost and normalize to 8-bit
     rgb = np.clip(rgb * brightness / 1023.0 * 255, 0, 255).astype(np.uint8)
 
-    # Flip upside down
-    rgb = np.flipud(rgb)
+    # An unflipped readout is upside down
+    if needs_rotation(order):
+        rgb = np.flipud(rgb)
 
     return rgb
 
-def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0):
+def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0,
+                       order='grbg'):
     """Convert raw Bayer file to PNG"""
 
     # Read raw file
@@ -52,8 +51,8 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0):
         data = data[:expected_size]
 
     # Convert to RGB
-    print(f"Converting Bayer to RGB (brightness={brightness})...")
-    rgb = bayer_to_rgb_simple(data, width, height, brightness)
+    print(f"Converting Bayer {order.upper()} to RGB (brightness={brightness})...")
+    rgb = bayer_to_rgb_simple(data, width, height, brightness, order)
 
     # Save as PNG
     output = Path(raw_file).with_suffix('.png')
@@ -71,12 +70,14 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0):
         return False
 
 if __name__ == "__main__":
+    order = bayer_arg(sys.argv)
     if len(sys.argv) < 2:
-        print("Usage: ./view_raw_bright.py <raw_file> [brightness=3.0]")
+        print("Usage: ./view_raw_bright.py [--bayer ORDER] <raw_file> [brightness=3.0]")
         print("Example: ./view_raw_bright.py test.raw 5.0")
+        print("ORDER defaults to the sensor's current one, else grbg")
         sys.exit(1)
 
     raw_file = sys.argv[1]
     brightness = float(sys.argv[2]) if len(sys.argv) > 2 else 3.0
 
-    convert_raw_to_png(raw_file, brightness=brightness)
+    convert_raw_to_png(raw_file, brightness=brightness, order=order)
@@ -5,6 +5,8 @@ import numpy as np
 import sys
 from pathlib import Path
 
+from raw_bayer import bayer_arg, needs_rotation, split_channels
+
 def apply_white_balance(r, g, b, method='gray_world'):
     """Apply white balance correction"""
     if method == 'gray_world':
@@ -22,18 +24,14 @@ def apply_white_balance(r, g, b, method='gray_world'):
 
     return r, g, b
 
-def bayer_to_rgb_improved(bayer, width, height, brightness=1.0, white_balance=True):
+def bayer_to_rgb_improved(bayer, width, height, brightness=1.0, white_balance=True,
+                          order='grbg'):
     """Improved Bayer to RGB conversion with white balance"""
     # Reshape to 2D array
     img = bayer.reshape(height, width)
 
-    # Extract R, G, B channels (GRBG pattern for BA10)
-    h2, w2 = height // 2, width // 2
-
-    g1 = img[0::2, 0::2][:h2, :w2].astype(np.float32)  # G channel (first)
-    r = img[0::2, 1::2][:h2, :w2].astype(np.float32)   # R channel
-    b = img[1::2, 0::2][:h2, :w2].astype(np.float32)   # B channel
-    g2 = img[1::2, 1::2][:h2, :w2].astype(np.float32)  # G channel (second)
+    # Extract R, G, B channels
+    r, g1, g2, b = (c.astype(np.float32) for c in split_channels(img, order))
 
     # Average the two green channels
     g = (g1 + g2) / 2
@@ -48,12 +46,14 @@ def bayer_to_rgb_improved(bayer, width, height, brightness=1.0, white_balance=Tr
     # Apply brightness and normalize to 8-bit
     rgb = np.clip(rgb * brightness / 1023.0 * 255, 0, 255).astype(np.uint8)
 
-    # Flip upside down
-    rgb = np.flipud(rgb)
+    # An unflipped readout is upside down
+    if needs_rotation(order):
+        rgb = np.flipud(rgb)
 
     return rgb
 
-def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=1.0, white_balance=True):
+def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=1.0, white_balance=True,
+                       order='grbg'):
     """Convert raw Bayer file to PNG with improved processing"""
 
     # Read raw file
@@ -74,8 +74,8 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=1.0, white_
         data = data[:expected_size]
 
     # Convert to RGB
-    print(f"Converting Bayer to RGB (brightness={brightness}, white_balance={white_balance})...")
-    rgb = bayer_to_rgb_improved(data, width, height, brightness, white_balance)
+    print(f"Converting Bayer {order.upper()} to RGB (brightness={brightness}, white_balance={white_balance})...")
+    rgb = bayer_to_rgb_improved(data, width, height, brightness, white_balance, order)
 
     # Save as PNG
     output = Path(raw_file).with_suffix('.png')
@@ -91,14 +91,16 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=1.0, white_
     return output
 
 if __name__ == "__main__":
+    order = bayer_arg(sys.argv)
     if len(sys.argv) < 2:
-        print("Usage: ./view_raw_improved.py <raw_file> [brightness] [white_balance]")
+        print("Usage: ./view_raw_improved.py [--bayer ORDER] <raw_file> [brightness] [white_balance]")
         print("  brightness: multiplier (default: 1.0)")
         print("  white_balance: on/off (default: on)")
+        print("  ORDER: grbg, rggb, bggr or gbrg (default: the sensor's, else grbg)")
         sys.exit(1)
 
     raw_file = sys.argv[1]
     brightness = float(sys.argv[2]) if len(sys.argv) > 2 else 1.0
     wb = sys.argv[3].lower() not in ['off', 'no', '0', 'false'] if len(sys.argv) > 3 else True
 
-    convert_raw_to_png(raw_file, brightness=brightness, white_balance=wb)
+    convert_raw_to_png(raw_file, brightness=brightness, white_balance=wb, order=order)
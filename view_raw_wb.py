@@ -1,10 +1,12 @@
 #!/usr/bin/env python3
-"""Convert raw Bayer GRBG10 image to viewable PNG with white balance and brightness boost"""
+"""Convert raw Bayer 10-bit image to viewable PNG with white balance and brightness boost"""
 
 import numpy as np
 import sys
 from pathlib import Path
 
+from raw_bayer import bayer_arg, needs_rotation, split_channels
+
 def apply_white_balance(rgb, method='gray_world'):
     """Apply white balance correction to RGB image
 
@@ -52,18 +54,14 @@ def apply_white_balance(rgb, method='gray_world'):
 
     return rgb_float
 
-def bayer_to_rgb_wb(bayer, width, height, brightness=3.0, wb_method='gray_world'):
+def bayer_to_rgb_wb(bayer, width, height, brightness=3.0, wb_method='gray_world',
+                    order='grbg'):
     """Bayer to RGB conversion with white balance and brightness adjustment"""
     # Reshape to 2D array
     img = bayer.reshape(height, width)
 
-    # Extract R, G, B channels (GRBG pattern)
-    h2, w2 = height // 2, width // 2
-
-    g1 = img[0::2, 0::2][:h2, :w2]  # G channel (first)
-    r = img[0::2, 1::2][:h2, :w2]   # R channel
-    b = img[1::2, 0::2][:h2, :w2]   # B channel
-    g2 = img[1::2, 1::2][:h2, :w2]  # G channel (second)
+    # Extract R, G, B channels
+    r, g1, g2, b = split_channels(img, order)
 
     # Average the two green channels
     g = (g1.astype(np.float32) + g2.astype(np.float32)) / 2
@@ -77,12 +75,14 @@ def bayer_to_rgb_wb(bayer, width, height, brightness=3.0, wb_method='gray_world'
     # Apply brightness boost and normalize to 8-bit
     rgb = np.clip(rgb * brightness / 1023.0 * 255, 0, 255).astype(np.uint8)
 
-    # Flip upside down
-    rgb = np.flipud(rgb)
+    # An unflipped readout is upside down
+    if needs_rotation(order):
+        rgb = np.flipud(rgb)
 
     return rgb
 
-def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0, wb_method='gray_world'):
+def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0, wb_method='gray_world',
+                       order='grbg'):
     """Convert raw Bayer file to PNG with white balance"""
 
     # Read raw file
@@ -103,8 +103,8 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0, wb_met
         data = data[:expected_size]
 
     # Convert to RGB with white balance
-    print(f"Converting Bayer to RGB (brightness={brightness}, wb={wb_method})...")
-    rgb = bayer_to_rgb_wb(data, width, height, brightness, wb_method)
+    print(f"Converting Bayer {order.upper()} to RGB (brightness={brightness}, wb={wb_method})...")
+    rgb = bayer_to_rgb_wb(data, width, height, brightness, wb_method, order)
 
     # Save as PNG
     output = Path(raw_file).with_suffix('.png')
@@ -122,14 +122,16 @@ def convert_raw_to_png(raw_file, width=1920, height=1080, brightness=3.0, wb_met
         return False
 
 if __name__ == "__main__":
+    order = bayer_arg(sys.argv)
     if len(sys.argv) < 2:
-        print("Usage: ./view_raw_wb.py <raw_file> [brightness=3.0] [wb_method=gray_world]")
+        print("Usage: ./view_raw_wb.py [--bayer ORDER] <raw_file> [brightness=3.0] [wb_method=gray_world]")
         print("Example: ./view_raw_wb.py test.raw 5.0 gray_world")
         print("White balance methods: gray_world, max_white")
+        print("ORDER defaults to the sensor's current one, else grbg")
         sys.exit(1)
 
     raw_file = sys.argv[1]
     brightness = float(sys.argv[2]) if len(sys.argv) > 2 else 3.0
     wb_method = sys.argv[3] if len(sys.argv) > 3 else 'gray_world'
 
-    convert_raw_to_png(raw_file, brightness=brightness, wb_method=wb_method)
+    convert_raw_to_png(raw_file, brightness=brightness, wb_method=wb_method, order=order)